@@ -0,0 +1,612 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+/**
+ * KUnit tests of the Ampire AM-4001280ATZQW-00H MIPI-DSI panel driver
+ *
+ * The driver is built into this module, so its static helpers can be driven
+ * against a fake DSI host. The host logs every packet with its type, payload
+ * and LP/HS mode, models the register file of the panel and keeps a virtual
+ * clock of the time the packets take on the link.
+ *
+ * Author:
+ * Jan Greiner <jan.greiner@mnet-mail.de>
+ */
+
+#define AM4001280_KUNIT
+#include "panel-ampire-am4001280atzqw00h.c"
+
+#include <kunit/test.h>
+
+/** Packets a single test may send */
+#define TEST_MAX_PACKETS 512
+
+/** Payload bytes logged per packet, a burst record being the longest */
+#define TEST_MAX_PAYLOAD MCS_BURST_MAX_LEN
+
+/** Entries of the built-in table the optimiser drops */
+#define TEST_OPTIMISED_ENTRIES (ARRAY_SIZE(mcs_am40001280) - 2)
+
+/** A packet as seen by the fake host */
+struct test_packet {
+	u8 type;
+	bool lpm;
+	size_t len;
+	u8 data[TEST_MAX_PAYLOAD];
+};
+
+/** A panel instance wired to the fake host */
+struct test_ctx {
+	struct device *dev;
+	struct mipi_dsi_host host;
+	struct mipi_dsi_device dsi;
+	struct panel_driver_data drv_data;
+
+	struct test_packet packets[TEST_MAX_PACKETS];
+	unsigned int num_packets;
+
+	/** Virtual time (in ns) the packets took on the link */
+	u64 link_ns;
+
+	/** Register file of the panel, written by generic writes */
+	u8 page;
+	u8 regs[256][256];
+};
+
+/**
+ * Log a packet, apply generic writes to the register file and answer reads from it.
+ */
+static ssize_t test_host_transfer(struct mipi_dsi_host *host, const struct mipi_dsi_msg *msg)
+{
+	struct test_ctx *ctx = container_of(host, struct test_ctx, host);
+	const struct panel_driver_data *drv_data = &ctx->drv_data;
+	const u8 *tx = msg->tx_buf;
+	struct test_packet *packet;
+	size_t wire_len;
+	size_t i;
+
+	if (ctx->num_packets == TEST_MAX_PACKETS || msg->tx_len > TEST_MAX_PAYLOAD)
+		return -ENOSPC;
+
+	packet = &ctx->packets[ctx->num_packets++];
+	packet->type = msg->type;
+	packet->lpm = msg->flags & MIPI_DSI_MSG_USE_LPM;
+	packet->len = msg->tx_len;
+	memcpy(packet->data, tx, msg->tx_len);
+
+	/** Short packets take 4 bytes, long ones add a 2 byte checksum to header and payload */
+	wire_len = mipi_dsi_packet_format_is_short(msg->type) ? 4 : 6 + msg->tx_len;
+	if (packet->lpm)
+		ctx->link_ns += div_u64((u64)wire_len * 8 * 1000, drv_data->max_lp_rate);
+	else
+		ctx->link_ns += div_u64((u64)wire_len * 8 * 1000, drv_data->max_hs_rate * ctx->dsi.lanes);
+
+	switch (msg->type) {
+	case MIPI_DSI_GENERIC_SHORT_WRITE_2_PARAM:
+	case MIPI_DSI_GENERIC_LONG_WRITE:
+		if (tx[0] == MCS_PAGE_SELECT)
+			ctx->page = tx[1];
+		else if (tx[0] != MCS_ACCESS_KEY)
+			for (i = 1; i < msg->tx_len; i++)
+				ctx->regs[ctx->page][(u8)(tx[0] + i - 1)] = tx[i];
+		break;
+	case MIPI_DSI_GENERIC_READ_REQUEST_1_PARAM:
+		memset(msg->rx_buf, 0, msg->rx_len);
+		if (msg->rx_len)
+			((u8 *)msg->rx_buf)[0] = ctx->regs[ctx->page][tx[0]];
+		return msg->rx_len;
+	default:
+		break;
+	}
+
+	return msg->rx_len ? msg->rx_len : msg->tx_len;
+}
+
+static const struct mipi_dsi_host_ops test_host_ops = {
+	.transfer = test_host_transfer,
+};
+
+static int test_init(struct kunit *test)
+{
+	struct panel_driver_data *drv_data;
+	struct test_ctx *ctx;
+
+	ctx = kunit_kzalloc(test, sizeof(*ctx), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, ctx);
+
+	ctx->dev = root_device_register("am4001280-test");
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, ctx->dev);
+
+	ctx->host.dev = ctx->dev;
+	ctx->host.ops = &test_host_ops;
+
+	ctx->dsi.host = &ctx->host;
+	ctx->dsi.dev.init_name = "am4001280-test-dsi";
+	ctx->dsi.lanes = 4;
+	ctx->dsi.format = MIPI_DSI_FMT_RGB888;
+	ctx->dsi.mode_flags = MIPI_DSI_MODE_VIDEO | MIPI_DSI_MODE_VIDEO_HSE;
+
+	drv_data = &ctx->drv_data;
+	drv_data->dsi = &ctx->dsi;
+	drv_data->pl_data = &am4001280atzqw00h_platform_data;
+	drv_data->panel_data = &am4001280atzqw00h_data;
+	drv_data->max_hs_rate = drv_data->panel_data->max_hs_rate;
+	drv_data->max_lp_rate = drv_data->panel_data->max_lp_rate;
+	drv_data->bus_format = MEDIA_BUS_FMT_RGB888_1X24;
+	mutex_init(&drv_data->lock);
+	mutex_init(&drv_data->mcs_lock);
+	init_completion(&drv_data->prepare_done);
+	complete_all(&drv_data->prepare_done);
+	dev_set_drvdata(&ctx->dsi.dev, drv_data);
+
+	test->priv = ctx;
+
+	return 0;
+}
+
+static void test_exit(struct kunit *test)
+{
+	struct test_ctx *ctx = test->priv;
+
+	/** Frees the compiled sequences along with the device */
+	root_device_unregister(ctx->dev);
+}
+
+/**
+ * Forget the packets sent so far, keeping the register file.
+ */
+static void test_clear_log(struct test_ctx *ctx)
+{
+	ctx->num_packets = 0;
+	ctx->link_ns = 0;
+}
+
+/**
+ * Compile a command set and send it through the fake host.
+ */
+static void test_send(struct kunit *test, const struct cmd_set_entry *cmd_set, size_t count,
+		      enum mcs_mode mode, struct mcs_report *report)
+{
+	struct test_ctx *ctx = test->priv;
+	struct panel_driver_data *drv_data = &ctx->drv_data;
+
+	KUNIT_ASSERT_EQ(test, 0, mcs_build(ctx->dev, &drv_data->mcs, &drv_data->mcs_signature, report,
+					   cmd_set, count, mode));
+
+	/** Low power mode, as raised while enabling */
+	ctx->dsi.mode_flags |= MIPI_DSI_MODE_LPM;
+	test_clear_log(ctx);
+	KUNIT_ASSERT_EQ(test, 0, push_mcs_seq(drv_data, &drv_data->mcs));
+	ctx->dsi.mode_flags &= ~MIPI_DSI_MODE_LPM;
+	KUNIT_EXPECT_EQ(test, drv_data->mcs.packets, ctx->num_packets);
+}
+
+/**
+ * Expand the logged generic writes into entries and compare them with the expected set.
+ */
+static void test_expect_entries(struct kunit *test, const struct cmd_set_entry *expected, size_t count)
+{
+	struct test_ctx *ctx = test->priv;
+	size_t n = 0;
+	unsigned int i;
+	size_t k;
+
+	for (i = 0; i < ctx->num_packets; i++) {
+		const struct test_packet *packet = &ctx->packets[i];
+
+		KUNIT_EXPECT_TRUE(test, packet->lpm);
+		KUNIT_EXPECT_EQ(test, packet->type, (u8)(packet->len == 2 ? MIPI_DSI_GENERIC_SHORT_WRITE_2_PARAM :
+								   MIPI_DSI_GENERIC_LONG_WRITE));
+
+		for (k = 1; k < packet->len; k++, n++) {
+			KUNIT_ASSERT_LT(test, n, count);
+			KUNIT_EXPECT_EQ(test, expected[n].cmd, (u8)(packet->data[0] + k - 1));
+			KUNIT_EXPECT_EQ(test, expected[n].param, packet->data[k]);
+		}
+	}
+
+	KUNIT_EXPECT_EQ(test, count, n);
+}
+
+/**
+ * Copy the built-in table without the two writes the optimiser drops.
+ */
+static struct cmd_set_entry *test_optimised_table(struct kunit *test)
+{
+	struct cmd_set_entry *expected;
+	size_t n = 0;
+	size_t i;
+
+	expected = kunit_kcalloc(test, TEST_OPTIMISED_ENTRIES, sizeof(*expected), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, expected);
+
+	for (i = 0; i < ARRAY_SIZE(mcs_am40001280); i++)
+		if (i != 6 && i != 141)
+			expected[n++] = mcs_am40001280[i];
+
+	return expected;
+}
+
+/**
+ * Single mode sends every entry as a packet of its own, in table order.
+ */
+static void test_mcs_single(struct kunit *test)
+{
+	struct test_ctx *ctx = test->priv;
+	struct panel_driver_data *drv_data = &ctx->drv_data;
+	unsigned int i;
+
+	test_send(test, mcs_am40001280, ARRAY_SIZE(mcs_am40001280), MCS_MODE_SINGLE, NULL);
+
+	KUNIT_EXPECT_EQ(test, 254u, drv_data->mcs.packets);
+	KUNIT_EXPECT_EQ(test, (size_t)254 * 3, drv_data->mcs.len);
+	for (i = 0; i < ctx->num_packets; i++)
+		KUNIT_EXPECT_EQ(test, (size_t)2, ctx->packets[i].len);
+	test_expect_entries(test, mcs_am40001280, ARRAY_SIZE(mcs_am40001280));
+
+	KUNIT_EXPECT_EQ(test, (u8)0x89, drv_data->mcs_signature.cmd);
+	KUNIT_EXPECT_EQ(test, (u8)0x03, drv_data->mcs_signature.param);
+}
+
+/**
+ * Burst mode merges register runs into 25 packets that write the same registers.
+ */
+static void test_mcs_burst(struct kunit *test)
+{
+	struct test_ctx *ctx = test->priv;
+	struct panel_driver_data *drv_data = &ctx->drv_data;
+	unsigned int i;
+
+	test_send(test, mcs_am40001280, ARRAY_SIZE(mcs_am40001280), MCS_MODE_BURST, NULL);
+
+	KUNIT_EXPECT_EQ(test, 25u, drv_data->mcs.packets);
+	for (i = 0; i < ctx->num_packets; i++)
+		KUNIT_EXPECT_LE(test, ctx->packets[i].len, (size_t)MCS_BURST_MAX_LEN);
+	test_expect_entries(test, mcs_am40001280, ARRAY_SIZE(mcs_am40001280));
+}
+
+/**
+ * Both modes leave the panel with the same register file.
+ */
+static void test_mcs_modes_equivalent(struct kunit *test)
+{
+	struct test_ctx *ctx = test->priv;
+	u8 (*single)[256];
+
+	single = kunit_kzalloc(test, sizeof(ctx->regs), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, single);
+
+	test_send(test, mcs_am40001280, ARRAY_SIZE(mcs_am40001280), MCS_MODE_SINGLE, NULL);
+	memcpy(single, ctx->regs, sizeof(ctx->regs));
+
+	memset(ctx->regs, 0, sizeof(ctx->regs));
+	test_send(test, mcs_am40001280, ARRAY_SIZE(mcs_am40001280), MCS_MODE_BURST, NULL);
+
+	KUNIT_EXPECT_EQ(test, 0, memcmp(single, ctx->regs, sizeof(ctx->regs)));
+}
+
+/**
+ * The optimiser drops exactly the superseded page 3 0x2C and page 2 0x0B writes.
+ */
+static void test_mcs_optimise(struct kunit *test)
+{
+	struct test_ctx *ctx = test->priv;
+	struct panel_driver_data *drv_data = &ctx->drv_data;
+	struct cmd_set_entry *expected = test_optimised_table(test);
+	struct mcs_report report;
+	u8 (*plain)[256];
+
+	plain = kunit_kzalloc(test, sizeof(ctx->regs), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, plain);
+
+	test_send(test, mcs_am40001280, ARRAY_SIZE(mcs_am40001280), MCS_MODE_SINGLE, NULL);
+	memcpy(plain, ctx->regs, sizeof(ctx->regs));
+	memset(ctx->regs, 0, sizeof(ctx->regs));
+
+	test_send(test, mcs_am40001280, ARRAY_SIZE(mcs_am40001280), MCS_MODE_SINGLE, &report);
+
+	KUNIT_EXPECT_EQ(test, ARRAY_SIZE(mcs_am40001280), report.entries);
+	KUNIT_ASSERT_EQ(test, (size_t)2, report.num_dropped);
+
+	KUNIT_EXPECT_EQ(test, (size_t)6, report.dropped[0].index);
+	KUNIT_EXPECT_EQ(test, 3, report.dropped[0].page);
+	KUNIT_EXPECT_EQ(test, (u8)0x2C, report.dropped[0].entry.cmd);
+	KUNIT_EXPECT_EQ(test, (u8)0x28, report.dropped[0].entry.param);
+	KUNIT_EXPECT_EQ(test, (enum mcs_drop_reason)MCS_DROP_SUPERSEDED, report.dropped[0].reason);
+
+	KUNIT_EXPECT_EQ(test, (size_t)141, report.dropped[1].index);
+	KUNIT_EXPECT_EQ(test, 2, report.dropped[1].page);
+	KUNIT_EXPECT_EQ(test, (u8)0x0B, report.dropped[1].entry.cmd);
+	KUNIT_EXPECT_EQ(test, (u8)0x10, report.dropped[1].entry.param);
+	KUNIT_EXPECT_EQ(test, (enum mcs_drop_reason)MCS_DROP_SUPERSEDED, report.dropped[1].reason);
+
+	KUNIT_EXPECT_EQ(test, 252u, drv_data->mcs.packets);
+	test_expect_entries(test, expected, TEST_OPTIMISED_ENTRIES);
+
+	/** Nothing dropped had any effect on the panel */
+	KUNIT_EXPECT_EQ(test, 0, memcmp(plain, ctx->regs, sizeof(ctx->regs)));
+
+	test_send(test, mcs_am40001280, ARRAY_SIZE(mcs_am40001280), MCS_MODE_BURST, &report);
+	KUNIT_EXPECT_EQ(test, (size_t)2, report.num_dropped);
+	KUNIT_EXPECT_EQ(test, 25u, drv_data->mcs.packets);
+	test_expect_entries(test, expected, TEST_OPTIMISED_ENTRIES);
+}
+
+/**
+ * Count the entries the optimiser drops from a small command set.
+ */
+static size_t test_count_dropped(struct kunit *test, const struct cmd_set_entry *cmd_set, size_t count)
+{
+	struct cmd_set_entry out[8];
+	struct mcs_drop dropped[8];
+	struct mcs_report report = { .dropped = dropped };
+	size_t kept;
+
+	KUNIT_ASSERT_LE(test, count, ARRAY_SIZE(out));
+
+	kept = mcs_optimise(cmd_set, count, out, &report);
+	KUNIT_EXPECT_EQ(test, count, kept + report.num_dropped);
+
+	return report.num_dropped;
+}
+
+/**
+ * Barriers, access key writes and page changes keep writes from being dropped.
+ */
+static void test_mcs_optimise_barriers(struct kunit *test)
+{
+	static const struct cmd_set_entry rewrite[] = {
+		{0xB1,0x01}, {0x10,0x01}, {0x10,0x02},
+	};
+	static const struct cmd_set_entry access_key[] = {
+		{0xB1,0x01}, {0x10,0x01}, {0xB0,0xA5}, {0x10,0x02},
+	};
+	static const struct cmd_set_entry ordered[] = {
+		{0xB1,0x01}, {0x10,0x01}, {0x20,0x00,0,true}, {0x10,0x02},
+	};
+	static const struct cmd_set_entry delayed[] = {
+		{0xB1,0x01}, {0x10,0x01,5}, {0x10,0x02},
+	};
+	static const struct cmd_set_entry other_page[] = {
+		{0xB1,0x01}, {0x10,0x01}, {0xB1,0x02}, {0x10,0x02},
+	};
+	static const struct cmd_set_entry page_selects[] = {
+		{0xB1,0x01}, {0xB1,0x02}, {0x10,0x01}, {0xB1,0x02}, {0x11,0x01},
+	};
+
+	KUNIT_EXPECT_EQ(test, (size_t)1, test_count_dropped(test, rewrite, ARRAY_SIZE(rewrite)));
+	KUNIT_EXPECT_EQ(test, (size_t)0, test_count_dropped(test, access_key, ARRAY_SIZE(access_key)));
+	KUNIT_EXPECT_EQ(test, (size_t)0, test_count_dropped(test, ordered, ARRAY_SIZE(ordered)));
+	KUNIT_EXPECT_EQ(test, (size_t)0, test_count_dropped(test, delayed, ARRAY_SIZE(delayed)));
+	KUNIT_EXPECT_EQ(test, (size_t)0, test_count_dropped(test, other_page, ARRAY_SIZE(other_page)));
+	KUNIT_EXPECT_EQ(test, (size_t)2, test_count_dropped(test, page_selects, ARRAY_SIZE(page_selects)));
+}
+
+/**
+ * A firmware image is unpacked into entries, its delays compiled into delay records.
+ */
+static void test_mcs_firmware(struct kunit *test)
+{
+	static const u8 image[] = {
+		'A', 'M', 'C', 'S', MCS_FW_VERSION, 0, 4, 0,
+		MCS_FW_OP_PAGE, 0x01, 0x00,
+		MCS_FW_OP_WRITE, 0x10, 0x01,
+		MCS_FW_OP_DELAY, 20, 0x00,
+		MCS_FW_OP_WRITE_ORDERED, 0x89, 0x03,
+	};
+	static const u8 compiled[] = {
+		2, 0xB1, 0x01,
+		2, 0x10, 0x01, 0, 20,
+		2, 0x89, 0x03,
+	};
+	struct test_ctx *ctx = test->priv;
+	struct firmware fw = { .data = image, .size = sizeof(image) };
+	struct cmd_set_entry *cmd_set;
+	struct mcs_seq seq;
+	size_t count;
+
+	KUNIT_ASSERT_EQ(test, 0, mcs_parse_firmware(ctx->dev, &fw, &cmd_set, &count));
+	KUNIT_ASSERT_EQ(test, (size_t)3, count);
+	KUNIT_EXPECT_EQ(test, (u8)20, cmd_set[1].delay);
+	KUNIT_EXPECT_TRUE(test, cmd_set[2].ordered);
+
+	KUNIT_EXPECT_EQ(test, 0, mcs_compile(ctx->dev, &seq, cmd_set, count, MCS_MODE_BURST));
+	kfree(cmd_set);
+
+	KUNIT_EXPECT_EQ(test, 3u, seq.packets);
+	KUNIT_ASSERT_EQ(test, sizeof(compiled), seq.len);
+	KUNIT_EXPECT_EQ(test, 0, memcmp(compiled, seq.buf, sizeof(compiled)));
+}
+
+/**
+ * Delay records sleep through the delay helper, counting in the sleep budget.
+ */
+static void test_mcs_delay(struct kunit *test)
+{
+	static const struct cmd_set_entry delayed[] = {
+		{0xB1,0x01}, {0x10,0x01,20}, {0x11,0x01,5}, {0x89,0x03},
+	};
+	struct test_ctx *ctx = test->priv;
+	struct panel_driver_data *drv_data = &ctx->drv_data;
+
+	drv_data->sleep_budget_ms = 0;
+	test_send(test, delayed, ARRAY_SIZE(delayed), MCS_MODE_BURST, NULL);
+
+	/** Nothing is merged across a delay */
+	KUNIT_EXPECT_EQ(test, 4u, ctx->num_packets);
+	KUNIT_EXPECT_EQ(test, 25u, drv_data->mcs.delay_ms);
+	KUNIT_EXPECT_EQ(test, 25u, drv_data->sleep_budget_ms);
+}
+
+/**
+ * Malformed firmware images are rejected.
+ */
+static void test_mcs_firmware_invalid(struct kunit *test)
+{
+	static const u8 bad_magic[] = { 'A', 'M', 'C', 'X', MCS_FW_VERSION, 0, 1, 0, MCS_FW_OP_WRITE, 0x10, 0x01 };
+	static const u8 short_header[] = { 'A', 'M', 'C', 'S', MCS_FW_VERSION, 0, 1 };
+	static const u8 truncated[] = { 'A', 'M', 'C', 'S', MCS_FW_VERSION, 0, 2, 0, MCS_FW_OP_WRITE, 0x10, 0x01 };
+	static const u8 over_long[] = { 'A', 'M', 'C', 'S', MCS_FW_VERSION, 0, 1, 0, MCS_FW_OP_WRITE, 0x10, 0x01,
+					MCS_FW_OP_WRITE, 0x11, 0x01 };
+	static const u8 bad_delay[] = { 'A', 'M', 'C', 'S', MCS_FW_VERSION, 0, 1, 0, MCS_FW_OP_DELAY, 10, 0x00 };
+	static const u8 bad_opcode[] = { 'A', 'M', 'C', 'S', MCS_FW_VERSION, 0, 1, 0, 0x7F, 0x10, 0x01 };
+	static const struct firmware images[] = {
+		{ .data = bad_magic, .size = sizeof(bad_magic) },
+		{ .data = short_header, .size = sizeof(short_header) },
+		{ .data = truncated, .size = sizeof(truncated) },
+		{ .data = over_long, .size = sizeof(over_long) },
+		{ .data = bad_delay, .size = sizeof(bad_delay) },
+		{ .data = bad_opcode, .size = sizeof(bad_opcode) },
+	};
+	struct test_ctx *ctx = test->priv;
+	struct cmd_set_entry *cmd_set;
+	size_t count;
+	unsigned int i;
+
+	for (i = 0; i < ARRAY_SIZE(images); i++)
+		KUNIT_EXPECT_EQ(test, -EINVAL, mcs_parse_firmware(ctx->dev, &images[i], &cmd_set, &count));
+}
+
+/**
+ * Check a logged DCS packet.
+ */
+static void test_expect_dcs(struct kunit *test, unsigned int index, u8 cmd)
+{
+	struct test_ctx *ctx = test->priv;
+	const struct test_packet *packet = &ctx->packets[index];
+
+	KUNIT_ASSERT_LT(test, index, ctx->num_packets);
+	KUNIT_EXPECT_EQ(test, cmd, packet->data[0]);
+	KUNIT_EXPECT_EQ(test, packet->type, (u8)(packet->len == 1 ? MIPI_DSI_DCS_SHORT_WRITE : MIPI_DSI_DCS_SHORT_WRITE_PARAM));
+}
+
+/**
+ * Full prepare and enable, checking the exact sequence and reporting the modelled latency.
+ */
+static void test_enable_sequence(struct kunit *test)
+{
+	struct test_ctx *ctx = test->priv;
+	struct panel_driver_data *drv_data = &ctx->drv_data;
+	const struct drm_panel_data *pd = drv_data->panel_data;
+	unsigned int mcs_packets;
+	unsigned int i;
+
+	test_send(test, mcs_am40001280, ARRAY_SIZE(mcs_am40001280), MCS_MODE_BURST, NULL);
+	mcs_packets = drv_data->mcs.packets;
+	memset(ctx->regs, 0, sizeof(ctx->regs));
+	test_clear_log(ctx);
+
+	KUNIT_ASSERT_EQ(test, 0, am4001280atzqw00h_power_on(drv_data));
+	KUNIT_EXPECT_EQ(test, 0u, ctx->num_packets);
+	KUNIT_EXPECT_EQ(test, pd->delay.prepare, drv_data->sleep_budget_ms);
+	kunit_info(test, "modelled prepare latency %u ms\n", drv_data->sleep_budget_ms);
+
+	KUNIT_ASSERT_EQ(test, 0, drv_data->pl_data->enable(drv_data));
+	KUNIT_EXPECT_TRUE(test, drv_data->enabled);
+	KUNIT_EXPECT_TRUE(test, drv_data->mcs_retained);
+	KUNIT_ASSERT_EQ(test, mcs_packets + 6, ctx->num_packets);
+
+	test_expect_dcs(test, 0, MIPI_DCS_SOFT_RESET);
+	test_expect_dcs(test, 1, MIPI_DCS_ENTER_SLEEP_MODE);
+	test_expect_dcs(test, 2, MIPI_DCS_SET_DISPLAY_OFF);
+	for (i = 3; i < 3 + mcs_packets; i++)
+		KUNIT_EXPECT_NE(test, (u8)MIPI_DSI_DCS_SHORT_WRITE, ctx->packets[i].type);
+	test_expect_dcs(test, i, MIPI_DCS_SET_PIXEL_FORMAT);
+	KUNIT_EXPECT_EQ(test, (u8)COL_FMT_24BPP, ctx->packets[i].data[1]);
+	test_expect_dcs(test, i + 1, MIPI_DCS_EXIT_SLEEP_MODE);
+	test_expect_dcs(test, i + 2, MIPI_DCS_SET_DISPLAY_ON);
+
+	/** Everything after the soft reset goes out in low power mode */
+	for (i = 1; i < ctx->num_packets; i++)
+		KUNIT_EXPECT_TRUE(test, ctx->packets[i].lpm);
+
+	KUNIT_EXPECT_EQ(test, pd->delay.enable, drv_data->sleep_budget_ms);
+	kunit_info(test, "modelled enable latency %llu us in %u packets\n",
+		   (u64)drv_data->sleep_budget_ms * USEC_PER_MSEC + div_u64(ctx->link_ns, NSEC_PER_USEC), ctx->num_packets);
+}
+
+/**
+ * A panel that kept its registers is enabled by reading the signature and waking it.
+ */
+static void test_enable_fast(struct kunit *test)
+{
+	struct test_ctx *ctx = test->priv;
+	struct panel_driver_data *drv_data = &ctx->drv_data;
+
+	test_send(test, mcs_am40001280, ARRAY_SIZE(mcs_am40001280), MCS_MODE_BURST, NULL);
+
+	KUNIT_ASSERT_EQ(test, 0, am4001280atzqw00h_power_on(drv_data));
+	KUNIT_ASSERT_EQ(test, 0, drv_data->pl_data->enable(drv_data));
+
+	/** What a disable leaves behind, supply and reset held */
+	KUNIT_ASSERT_EQ(test, 0, am4001280atzqw00h_suspend(&ctx->dsi.dev));
+	drv_data->enabled = false;
+
+	test_clear_log(ctx);
+	KUNIT_ASSERT_EQ(test, 0, drv_data->pl_data->enable(drv_data));
+
+	KUNIT_ASSERT_EQ(test, 3u, ctx->num_packets);
+	KUNIT_EXPECT_EQ(test, (u8)MIPI_DSI_GENERIC_READ_REQUEST_1_PARAM, ctx->packets[0].type);
+	KUNIT_EXPECT_EQ(test, drv_data->mcs_signature.cmd, ctx->packets[0].data[0]);
+	test_expect_dcs(test, 1, MIPI_DCS_EXIT_SLEEP_MODE);
+	test_expect_dcs(test, 2, MIPI_DCS_SET_DISPLAY_ON);
+
+	kunit_info(test, "modelled fast enable latency %llu us in %u packets\n",
+		   (u64)drv_data->sleep_budget_ms * USEC_PER_MSEC + div_u64(ctx->link_ns, NSEC_PER_USEC), ctx->num_packets);
+}
+
+/**
+ * A panel mounted upside down is flipped in both directions by set_address_mode.
+ */
+static void test_enable_rotation_180(struct kunit *test)
+{
+	struct test_ctx *ctx = test->priv;
+	struct panel_driver_data *drv_data = &ctx->drv_data;
+	unsigned int i;
+
+	KUNIT_ASSERT_EQ(test, 0, am4001280atzqw00h_set_rotation(drv_data, 180, false, false));
+	KUNIT_EXPECT_EQ(test, (enum drm_panel_orientation)DRM_MODE_PANEL_ORIENTATION_NORMAL, drv_data->orientation);
+
+	test_send(test, mcs_am40001280, ARRAY_SIZE(mcs_am40001280), MCS_MODE_BURST, NULL);
+	test_clear_log(ctx);
+
+	KUNIT_ASSERT_EQ(test, 0, am4001280atzqw00h_power_on(drv_data));
+	KUNIT_ASSERT_EQ(test, 0, drv_data->pl_data->enable(drv_data));
+
+	for (i = 0; i < ctx->num_packets; i++)
+		if (ctx->packets[i].data[0] == MIPI_DCS_SET_ADDRESS_MODE &&
+		    ctx->packets[i].type == MIPI_DSI_DCS_SHORT_WRITE_PARAM)
+			break;
+
+	KUNIT_ASSERT_LT(test, i, ctx->num_packets);
+	test_expect_dcs(test, i, MIPI_DCS_SET_ADDRESS_MODE);
+
+	/** The flip bits, which unlike the GRAM order bits also turn the video mode scan-out */
+	KUNIT_EXPECT_EQ(test, (u8)(BIT(1) | BIT(0)), ctx->packets[i].data[1]);
+}
+
+static struct kunit_case am4001280atzqw00h_test_cases[] = {
+	KUNIT_CASE(test_mcs_single),
+	KUNIT_CASE(test_mcs_burst),
+	KUNIT_CASE(test_mcs_modes_equivalent),
+	KUNIT_CASE(test_mcs_optimise),
+	KUNIT_CASE(test_mcs_optimise_barriers),
+	KUNIT_CASE(test_mcs_firmware),
+	KUNIT_CASE(test_mcs_firmware_invalid),
+	KUNIT_CASE(test_mcs_delay),
+	KUNIT_CASE(test_enable_sequence),
+	KUNIT_CASE(test_enable_fast),
+	KUNIT_CASE(test_enable_rotation_180),
+	{}
+};
+
+static struct kunit_suite am4001280atzqw00h_test_suite = {
+	.name = "panel-ampire-am4001280atzqw00h",
+	.init = test_init,
+	.exit = test_exit,
+	.test_cases = am4001280atzqw00h_test_cases,
+};
+kunit_test_suite(am4001280atzqw00h_test_suite);
+
+MODULE_AUTHOR("Jan Greiner <jan.greiner@mnet-mail.de>");
+MODULE_DESCRIPTION("KUnit tests of the Ampire AM-4001280ATZQW-00H MIPI DSI panel driver");
+MODULE_LICENSE("GPL v2");
@@ -0,0 +1,128 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+
+/**
+ * Tracepoints of the Ampire AM-4001280ATZQW-00H MIPI-DSI panel driver
+ *
+ * Author:
+ * Jan Greiner <jan.greiner@mnet-mail.de>
+ */
+
+/** The KUnit module carries its own copy of the events */
+#undef TRACE_SYSTEM
+#ifdef AM4001280_KUNIT
+#define TRACE_SYSTEM am4001280_test
+#else
+#define TRACE_SYSTEM am4001280
+#endif
+
+#if !defined(_PANEL_AMPIRE_AM4001280ATZQW00H_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _PANEL_AMPIRE_AM4001280ATZQW00H_TRACE_H
+
+#include <linux/tracepoint.h>
+
+#include <drm/drm_mipi_dsi.h>
+
+/** A single generic write of the Manufacturer Command Set */
+TRACE_EVENT(am4001280_mcs_write,
+	TP_PROTO(const struct mipi_dsi_device *dsi, const u8 *data, size_t len, int ret),
+	TP_ARGS(dsi, data, len, ret),
+	TP_STRUCT__entry(
+		__string(dev, dev_name(&dsi->dev))
+		__field(bool, lpm)
+		__field(size_t, len)
+		__field(int, ret)
+		__dynamic_array(u8, data, len)
+	),
+	TP_fast_assign(
+		__assign_str(dev, dev_name(&dsi->dev));
+		__entry->lpm = !!(dsi->mode_flags & MIPI_DSI_MODE_LPM);
+		__entry->len = len;
+		__entry->ret = ret;
+		memcpy(__get_dynamic_array(data), data, len);
+	),
+	TP_printk("%s %s len=%zu ret=%d data=%s", __get_str(dev),
+		  __entry->lpm ? "lp" : "hs", __entry->len, __entry->ret,
+		  __print_hex(__get_dynamic_array(data), __entry->len))
+);
+
+/** A DCS command or a register read */
+TRACE_EVENT(am4001280_dcs,
+	TP_PROTO(const struct mipi_dsi_device *dsi, u8 cmd, int ret),
+	TP_ARGS(dsi, cmd, ret),
+	TP_STRUCT__entry(
+		__string(dev, dev_name(&dsi->dev))
+		__field(bool, lpm)
+		__field(u8, cmd)
+		__field(int, ret)
+	),
+	TP_fast_assign(
+		__assign_str(dev, dev_name(&dsi->dev));
+		__entry->lpm = !!(dsi->mode_flags & MIPI_DSI_MODE_LPM);
+		__entry->cmd = cmd;
+		__entry->ret = ret;
+	),
+	TP_printk("%s %s cmd=0x%02x ret=%d", __get_str(dev),
+		  __entry->lpm ? "lp" : "hs", __entry->cmd, __entry->ret)
+);
+
+/** A sequencing delay with its requested and actual duration */
+TRACE_EVENT(am4001280_sleep,
+	TP_PROTO(const struct device *dev, s64 requested_us, s64 actual_us),
+	TP_ARGS(dev, requested_us, actual_us),
+	TP_STRUCT__entry(
+		__string(dev, dev_name(dev))
+		__field(s64, requested_us)
+		__field(s64, actual_us)
+	),
+	TP_fast_assign(
+		__assign_str(dev, dev_name(dev));
+		__entry->requested_us = requested_us;
+		__entry->actual_us = actual_us;
+	),
+	TP_printk("%s requested=%lldus actual=%lldus", __get_str(dev),
+		  __entry->requested_us, __entry->actual_us)
+);
+
+/** A change of the prepared, enabled or suspended state */
+TRACE_EVENT(am4001280_state,
+	TP_PROTO(const struct device *dev, const char *state, bool value),
+	TP_ARGS(dev, state, value),
+	TP_STRUCT__entry(
+		__string(dev, dev_name(dev))
+		__string(state, state)
+		__field(bool, value)
+	),
+	TP_fast_assign(
+		__assign_str(dev, dev_name(dev));
+		__assign_str(state, state);
+		__entry->value = value;
+	),
+	TP_printk("%s %s=%d", __get_str(dev), __get_str(state), __entry->value)
+);
+
+/** A brightness update sent to the panel */
+TRACE_EVENT(am4001280_backlight,
+	TP_PROTO(const struct device *dev, int brightness, int ret),
+	TP_ARGS(dev, brightness, ret),
+	TP_STRUCT__entry(
+		__string(dev, dev_name(dev))
+		__field(int, brightness)
+		__field(int, ret)
+	),
+	TP_fast_assign(
+		__assign_str(dev, dev_name(dev));
+		__entry->brightness = brightness;
+		__entry->ret = ret;
+	),
+	TP_printk("%s brightness=%d ret=%d", __get_str(dev),
+		  __entry->brightness, __entry->ret)
+);
+
+#endif /* _PANEL_AMPIRE_AM4001280ATZQW00H_TRACE_H */
+
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE panel-ampire-am4001280atzqw00h-trace
+
+#include <trace/define_trace.h>
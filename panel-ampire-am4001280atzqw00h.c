@@ -27,15 +27,23 @@
 
 
 #include <linux/backlight.h>
+#include <linux/completion.h>
+#include <linux/debugfs.h>
 #include <linux/delay.h>
+#include <linux/firmware.h>
 #include <linux/gpio/consumer.h>
+#include <linux/interrupt.h>
 #include <linux/jiffies.h>
 #include <linux/module.h>
 #include <linux/device.h>
 #include <linux/of_device.h>
 #include <linux/pm_runtime.h>
 #include <linux/regulator/consumer.h>
+#include <linux/seq_file.h>
+#include <linux/slab.h>
+#include <linux/wait.h>
 #include <linux/media-bus-format.h>
+#include <linux/workqueue.h>
 
 #include <video/mipi_display.h>
 #include <video/of_videomode.h>
@@ -45,29 +53,169 @@
 #include <drm/drm_mipi_dsi.h>
 #include <drm/drm_panel.h>
 #include <drm/drm_print.h>
+#include <drm/drm_rect.h>
+
+#include "panel-ampire-am4001280atzqw00h.h"
+
+/** Built into the KUnit module, which must neither export nor bind anything */
+#ifdef AM4001280_KUNIT
+#undef EXPORT_SYMBOL_GPL
+#define EXPORT_SYMBOL_GPL(sym)
+#endif
+
+#define CREATE_TRACE_POINTS
+#include "panel-ampire-am4001280atzqw00h-trace.h"
 
 /** Panel specific color-format bits */
 #define COL_FMT_16BPP 0x55
 #define COL_FMT_18BPP 0x66
 #define COL_FMT_24BPP 0x77
 
+/**
+ * Flip bits of DCS set_address_mode.
+ *
+ * Unlike the GRAM access order bits 7 and 6, these flip the scan-out itself
+ * and so also apply in video mode.
+ */
+#define ADDRESS_MODE_FLIP_HORIZONTAL BIT(1)
+#define ADDRESS_MODE_FLIP_VERTICAL BIT(0)
+
 /** Write Manufacture Command Set Control */
 #define WRMAUCCTR 0xFE
 
 /** Amount of volage/current regulators. */
 #define DCS_REGULATOR_SUPPLY_NUM 2
 
+/** Manufacturer Command Set access key register */
+#define MCS_ACCESS_KEY 0xB0
+
+/** Manufacturer Command Set page select register */
+#define MCS_PAGE_SELECT 0xB1
+
+/** Longest generic write (register address included) a merged MCS packet may grow to */
+#define MCS_BURST_MAX_LEN 32
+
+/** Transfer modes for the Manufacturer Command Set */
+enum mcs_mode {
+	/** One generic write per register, exactly as received from Ampire */
+	MCS_MODE_SINGLE = 0,
+	/** Runs of consecutive registers within a page merged into long generic writes */
+	MCS_MODE_BURST = 1,
+};
+
+/** Number of log2 buckets of the latency histograms, the last one collecting everything above 2^19 us */
+#define LATENCY_HIST_BUCKETS 21
+
+/** Operations latency statistics are kept for */
+enum latency_op {
+	LATENCY_PREPARE,
+	LATENCY_ENABLE,
+	LATENCY_DISABLE,
+	LATENCY_UNPREPARE,
+	LATENCY_BL_UPDATE,
+	LATENCY_BL_GET,
+	LATENCY_OP_COUNT
+};
+
+/** Cumulative latency statistics of a single operation */
+struct latency_stats {
+	u64 count;
+	u64 total_us;
+	u64 min_us;
+	u64 max_us;
+
+	/** Bucket n counts latencies in [2^(n-1), 2^n) us, bucket 0 those below 1 us */
+	u32 hist[LATENCY_HIST_BUCKETS];
+};
+
 /** Manufacturer Command Set pages (CMD2) format */
 struct cmd_set_entry {
 	u8 cmd;
 	u8 param;
+
+	/** Time (in ms) to wait after the write */
+	u8 delay;
+
+	/** Latches state, so neither this nor writes before it may be optimised away */
+	bool ordered;
+};
+
+/**
+ * Precompiled Manufacturer Command Set.
+ *
+ * The buffer holds records of the form [length][register][param...], each of
+ * which is sent as a single generic write. A zero length record [0][ms] is a
+ * delay instead.
+ */
+struct mcs_seq {
+	u8 *buf;
+	size_t len;
+
+	/** Number of DSI packets needed to send the whole sequence */
+	unsigned int packets;
+
+	/** Sum of the delay records in ms */
+	u32 delay_ms;
+};
+
+/** Why the optimiser dropped an entry */
+enum mcs_drop_reason {
+	MCS_DROP_SUPERSEDED,
+	MCS_DROP_PAGE_SELECT,
+};
+
+/** An entry dropped from a command set, "page" being -1 before the first page select */
+struct mcs_drop {
+	size_t index;
+	int page;
+	struct cmd_set_entry entry;
+	enum mcs_drop_reason reason;
+};
+
+/** Outcome of optimising a command set */
+struct mcs_report {
+	size_t entries;
+	size_t num_dropped;
+	struct mcs_drop *dropped;
 };
 
+/**
+ * Manufacturer Command Set firmware format.
+ *
+ * A header is followed by "count" operations of three bytes each. Delays are
+ * added to the write before them.
+ */
+#define MCS_FW_MAGIC "AMCS"
+#define MCS_FW_VERSION 1
+
+struct mcs_fw_header {
+	u8 magic[4];
+	u8 version;
+	u8 reserved;
+	__le16 count;
+} __packed;
+
+enum mcs_fw_opcode {
+	/** Write arg[1] to register arg[0] of the selected page */
+	MCS_FW_OP_WRITE,
+	/** Select page arg[0] */
+	MCS_FW_OP_PAGE,
+	/** Wait arg[0] ms after the previous write */
+	MCS_FW_OP_DELAY,
+	/** Like MCS_FW_OP_WRITE, kept in order by the optimiser */
+	MCS_FW_OP_WRITE_ORDERED,
+};
+
+struct mcs_fw_op {
+	u8 opcode;
+	u8 arg[2];
+} __packed;
+
 /**
  * Command Set Pages received from Ampire.
  */
 static const struct cmd_set_entry mcs_am40001280[] = {
-  {0xB0,0x5A}, {0xB1,0x00}, {0x89,0x01}, {0x91,0x07},
+  {0xB0,0x5A}, {0xB1,0x00}, {0x89,0x01,0,true}, {0x91,0x07},
   {0x92,0xF9}, {0xB1,0x03}, {0x2C,0x28}, {0x00,0xB7},
   {0x01,0x1B}, {0x02,0x00}, {0x03,0x00}, {0x04,0x00},
   {0x05,0x00}, {0x06,0x00}, {0x07,0x00}, {0x08,0x00},
@@ -130,7 +278,7 @@ static const struct cmd_set_entry mcs_am40001280[] = {
   {0x77,0x00}, {0x78,0x00}, {0x79,0x00}, {0x7A,0xDC},
   {0x7B,0xDC}, {0x7C,0xDC}, {0x7D,0xDC}, {0x7E,0xDC},
   {0x7F,0x6E}, {0x0B,0x00}, {0xB1,0x03}, {0x2C,0x2C},
-  {0xB1,0x00}, {0x89,0x03}
+  {0xB1,0x00}, {0x89,0x03,0,true}
 };
 
 /**
@@ -149,8 +297,12 @@ struct panel_driver_data {
 	struct regulator *supply;
 	struct i2c_adapter *ddc;
 
-	unsigned long hw_guard_end;
-	unsigned long hw_guard_wait;
+	/** Earliest time the panel may be powered up again, and the ms it needs after unprepare */
+	ktime_t hw_guard_end;
+	u32 hw_guard_wait;
+
+	/** Delays (in ms) requested by the sequence currently running */
+	u32 sleep_budget_ms;
 
 	const struct drm_panel_data *panel_data;
 	const struct platform_data *pl_data;
@@ -163,13 +315,113 @@ struct panel_driver_data {
 	struct regulator_bulk_data *supplies;
 	int num_supplies;
 
+	/**
+	 * Manufacturer Command Set as sent while enabling. "mcs_lock" guards it,
+	 * its signature and report against a firmware swap, but never "lock",
+	 * so brightness and idle updates don't wait for the transfer.
+	 */
+	enum mcs_mode mcs_mode;
+	struct mutex mcs_lock;
+	struct mcs_seq mcs;
+	s64 mcs_time_us;
+
+	/** Send the MCS in high-speed mode, cleared if the panel did not take it */
+	bool mcs_hs;
+
+	/** Register read back to tell whether the panel still holds the MCS */
+	struct cmd_set_entry mcs_signature;
+
+	/** Drop writes without effect from the MCS, see "mcs_report" */
+	bool mcs_optimise;
+	struct mcs_report mcs_report;
+
 	/* Runtime variables */
 	bool prepared;
 	bool enabled;
 	bool suspended;
 
+	/** Set while supply and reset line have been held since the MCS was sent */
+	bool mcs_retained;
+
+	/** Adopt a panel the bootloader left running instead of resetting it */
+	bool seamless_handoff;
+	/** Set from adopting a live panel until the first enable */
+	bool handed_off;
+
+	/** Set while runtime PM powered the panel down behind the back of DRM */
+	bool idle_off;
+
+	/** Asynchronous bring-up, fenced by "prepare_done" */
+	bool async_prepare;
+	struct workqueue_struct *wq;
+	struct work_struct prepare_work;
+	struct completion prepare_done;
+	int prepare_ret;
+
+	/** Brightness updates, coalesced to at most one DSI write per frame */
+	struct delayed_work bl_work;
+	/** Own queue, so the TE wait of a flush doesn't hold up the work on "wq" */
+	struct workqueue_struct *bl_wq;
+	int bl_pending;
+	ktime_t bl_last_flush;
+
+	/** Brightness last written to the panel, reported instead of reading it back */
+	int bl_actual;
+
+	/** Use the two byte brightness value of the large DCS brightness commands */
+	bool bl_16bit;
+	/** Optional table mapping brightness levels to panel values */
+	u32 *bl_lut;
+	unsigned int bl_levels;
+
+	/** Kernel-side brightness fade, protected by "lock" */
+	struct delayed_work fade_work;
+	int fade_from;
+	int fade_to;
+	ktime_t fade_start;
+	s64 fade_duration_us;
+
+	/** Idle mode entered after "idle_timeout_ms" without damage, protected by "lock" */
+	struct delayed_work idle_work;
+	u32 idle_timeout_ms;
+	bool idle;
+
+	/** MCS firmware replacing the built-in sequence once loaded, see "mcs" */
+	const char *fw_name;
+	struct completion fw_done;
+
+	/** Bus format the DSI pixel format was selected for */
+	u32 bus_format;
+
+	/** The video mode was picked from the link load instead of "video-mode" */
+	bool video_mode_auto;
+
+	/** Link rates (in Mbit/s) of "panel_data", unless overridden in the device tree */
+	u32 max_hs_rate;
+	u32 max_lp_rate;
+
+	/** DSI command mode, the panel refreshing itself from its GRAM */
+	bool command_mode;
+
+	/** Tearing effect line, timestamped as the vblank source of the panel */
+	struct gpio_desc *te_gpio;
+	wait_queue_head_t te_wait;
+	spinlock_t te_lock;
+	unsigned long te_count;
+	ktime_t te_timestamp;
+	s64 te_period_us;
+
+	/** Latency statistics of the panel and backlight callbacks */
+	struct latency_stats stats[LATENCY_OP_COUNT];
+	spinlock_t stats_lock;
+	struct dentry *debugfs;
+
+	/** Mounting rotation the panel cannot compensate, reported to userspace */
 	enum drm_panel_orientation orientation;
 
+	/** Scan direction compensating 180 degree mounting and mirroring */
+	u8 address_mode;
+
 	bool intro_printed;
 };
 
@@ -190,6 +442,9 @@ struct drm_panel_data {
 	 */
 	const struct drm_display_mode *modes;
 
+	/** @num_modes: Number of elements in modes array. */
+	u32 num_modes;
+
 	/**
 	 * @timings: Pointer to array of display timings.
 	 
@@ -229,9 +484,9 @@ struct drm_panel_data {
 	/** @refresh: Refresh rate framerate (in Hz). */
 	u32 refresh;
 
-	/** @max_hs_rate: Maximum data transfer rate in highspeed mode. */
+	/** @max_hs_rate: Maximum data transfer rate in highspeed mode (in Mbit/s per lane). */
 	u32 max_hs_rate;
-	/** @max_lp_rate: Maximum data transfer rate in lowpseed mode. */
+	/** @max_lp_rate: Maximum data transfer rate in lowpseed mode (in Mbit/s). */
 	u32 max_lp_rate;
 
 	/** Support for the tearing effect output signal on the TE signal line */
@@ -247,6 +502,22 @@ struct drm_panel_data {
 		 */
 		u32 prepare;
 
+		/**
+		 * @delay.reset: Time for the panel to leave reset.
+		 *
+		 * The time (in milliseconds) that it takes after reset-out
+		 * until the panel accepts commands.
+		 */
+		u32 reset;
+
+		/**
+		 * @delay.reset_assert: Time to hold the reset line.
+		 *
+		 * The time (in milliseconds) the reset line is held asserted
+		 * while powering down.
+		 */
+		u32 reset_assert;
+
 		/**
 		 * @delay.enable: Time for the panel to display a valid frame.
 		 *
@@ -294,24 +565,313 @@ static inline struct panel_driver_data *panel_to_drv_data(struct drm_panel *pane
 }
 
 /**
+ * Whether an entry switches the MCS page or access state and thus must not be merged.
+ */
+static bool mcs_entry_is_control(const struct cmd_set_entry *entry)
+{
+	return entry->cmd == MCS_ACCESS_KEY || entry->cmd == MCS_PAGE_SELECT;
+}
+
+/**
+ * Compile a command set into a sequence of generic writes.
  *
+ * In burst mode every run of consecutive register addresses within the same
+ * page is merged into one long write, relying on the controller's address
+ * auto-increment. In single mode every entry is sent on its own.
  */
-static int push_cmd_list(struct mipi_dsi_device *dsi, struct cmd_set_entry const *cmd_set, size_t count)
+static int mcs_compile(struct device *dev, struct mcs_seq *seq, struct cmd_set_entry const *cmd_set, size_t count, enum mcs_mode mode)
 {
-	int ret;
+	u8 *buf;
+	u8 *rec = NULL;
+	size_t len = 0;
 	size_t i;
 
+	/** Worst case every entry ends up in a record of its own, followed by a delay */
+	buf = devm_kmalloc(dev, count * 5, GFP_KERNEL);
+	if (!buf)
+		return -ENOMEM;
+
+	seq->packets = 0;
+	seq->delay_ms = 0;
+
 	for (i = 0; i < count; i++) {
-		const struct cmd_set_entry *entry = cmd_set++;
-		u8 buffer[2] = { entry->cmd, entry->param };
+		const struct cmd_set_entry *entry = &cmd_set[i];
+
+		if (mode == MCS_MODE_BURST && rec &&
+		    !mcs_entry_is_control(entry) &&
+		    !mcs_entry_is_control(&cmd_set[i - 1]) &&
+		    entry->cmd == cmd_set[i - 1].cmd + 1 &&
+		    rec[0] < MCS_BURST_MAX_LEN) {
+			buf[len++] = entry->param;
+			rec[0]++;
+			continue;
+		}
 
-		ret = mipi_dsi_generic_write(dsi, &buffer, sizeof(buffer));
-		if (ret < 0)
-			return ret;
+		rec = &buf[len];
+		buf[len++] = 2;
+		buf[len++] = entry->cmd;
+		buf[len++] = entry->param;
+		seq->packets++;
+
+		/** Nothing may be merged across a delay */
+		if (entry->delay) {
+			buf[len++] = 0;
+			buf[len++] = entry->delay;
+			seq->delay_ms += entry->delay;
+			rec = NULL;
+		}
 	}
 
+	seq->buf = buf;
+	seq->len = len;
+
 	return 0;
-};
+}
+
+/**
+ * Whether an entry pins the optimiser, either latching state or being followed by a delay.
+ */
+static bool mcs_entry_is_barrier(const struct cmd_set_entry *entry)
+{
+	return entry->ordered || entry->delay;
+}
+
+/**
+ * Drop the entries of a command set that have no effect.
+ *
+ * The page select state is modelled while walking the set. A write is
+ * superseded if the same register of the same page is written again before
+ * any barrier or access key write. A page select is dropped if it selects the page already
+ * selected or is followed by another page select right away. Access key
+ * writes and barriers are always kept.
+ *
+ * Returns the number of entries written to "out", which has room for "count".
+ */
+static size_t mcs_optimise(const struct cmd_set_entry *cmd_set, size_t count, struct cmd_set_entry *out, struct mcs_report *report)
+{
+	size_t num_superseded;
+	size_t kept = 0;
+	size_t d = 0;
+	int page = -1;
+	int next_page;
+	bool superseded;
+	size_t i, j, k;
+
+	report->entries = count;
+	report->num_dropped = 0;
+
+	/** Find superseded writes, in order of their index */
+	for (i = 0; i < count; i++) {
+		const struct cmd_set_entry *entry = &cmd_set[i];
+
+		if (entry->cmd == MCS_PAGE_SELECT)
+			page = entry->param;
+
+		if (mcs_entry_is_control(entry) || mcs_entry_is_barrier(entry))
+			continue;
+
+		/** Locking or unlocking the command set may change what a write does */
+		next_page = page;
+		superseded = false;
+		for (j = i + 1; j < count && !mcs_entry_is_barrier(&cmd_set[j]); j++) {
+			if (cmd_set[j].cmd == MCS_ACCESS_KEY)
+				break;
+
+			if (cmd_set[j].cmd == MCS_PAGE_SELECT) {
+				next_page = cmd_set[j].param;
+			} else if (next_page == page && cmd_set[j].cmd == entry->cmd) {
+				superseded = true;
+				break;
+			}
+		}
+
+		if (superseded)
+			report->dropped[report->num_dropped++] = (struct mcs_drop) {
+				.index = i,
+				.page = page,
+				.entry = *entry,
+				.reason = MCS_DROP_SUPERSEDED,
+			};
+	}
+	num_superseded = report->num_dropped;
+
+	/** Emit the rest, dropping page selects left without effect */
+	page = -1;
+	for (i = 0; i < count; i++) {
+		const struct cmd_set_entry *entry = &cmd_set[i];
+
+		if (d < num_superseded && report->dropped[d].index == i) {
+			d++;
+			continue;
+		}
+
+		if (entry->cmd == MCS_PAGE_SELECT && !mcs_entry_is_barrier(entry)) {
+			/** The next entry still sent after this one */
+			for (k = i + 1, j = d; k < count && j < num_superseded && report->dropped[j].index == k; k++, j++)
+				;
+
+			if (entry->param == page || (k < count && cmd_set[k].cmd == MCS_PAGE_SELECT)) {
+				report->dropped[report->num_dropped++] = (struct mcs_drop) {
+					.index = i,
+					.page = page,
+					.entry = *entry,
+					.reason = MCS_DROP_PAGE_SELECT,
+				};
+				continue;
+			}
+		}
+
+		if (entry->cmd == MCS_PAGE_SELECT)
+			page = entry->param;
+
+		out[kept++] = *entry;
+	}
+
+	return kept;
+}
+
+/**
+ * Pick the signature register of a command set.
+ *
+ * This is the last register written that is not a page or access control,
+ * which is still addressable on the page the set leaves selected.
+ */
+static void mcs_find_signature(struct cmd_set_entry *signature, struct cmd_set_entry const *cmd_set, size_t count)
+{
+	while (count--) {
+		if (!mcs_entry_is_control(&cmd_set[count])) {
+			*signature = cmd_set[count];
+			return;
+		}
+	}
+
+	signature->cmd = 0;
+	signature->param = 0;
+}
+
+/**
+ * Optimise, compile and pick the signature of a command set.
+ *
+ * Optimisation is skipped without a report to fill in.
+ */
+static int mcs_build(struct device *dev, struct mcs_seq *seq, struct cmd_set_entry *signature, struct mcs_report *report,
+		     struct cmd_set_entry const *cmd_set, size_t count, enum mcs_mode mode)
+{
+	struct cmd_set_entry *optimised = NULL;
+	int ret;
+
+	if (report) {
+		optimised = kmalloc_array(count, sizeof(*optimised), GFP_KERNEL);
+		report->dropped = devm_kcalloc(dev, count, sizeof(*report->dropped), GFP_KERNEL);
+		if (!optimised || !report->dropped) {
+			kfree(optimised);
+			return -ENOMEM;
+		}
+
+		count = mcs_optimise(cmd_set, count, optimised, report);
+		cmd_set = optimised;
+	}
+
+	ret = mcs_compile(dev, seq, cmd_set, count, mode);
+	mcs_find_signature(signature, cmd_set, count);
+
+	kfree(optimised);
+
+	return ret;
+}
+
+/**
+ * Validate a firmware image and unpack it into a command set.
+ *
+ * The returned command set has to be freed by the caller.
+ */
+static int mcs_parse_firmware(struct device *dev, const struct firmware *fw, struct cmd_set_entry **cmd_set, size_t *count)
+{
+	const struct mcs_fw_header *header = (const void *)fw->data;
+	const struct mcs_fw_op *op;
+	struct cmd_set_entry *entries;
+	size_t num_ops;
+	size_t n = 0;
+	size_t i;
+
+	if (fw->size < sizeof(*header) || memcmp(header->magic, MCS_FW_MAGIC, sizeof(header->magic))) {
+		DRM_DEV_ERROR(dev, "Got MCS firmware without a valid header\n");
+		return -EINVAL;
+	}
+
+	if (header->version != MCS_FW_VERSION) {
+		DRM_DEV_ERROR(dev, "Got unsupported MCS firmware version %u\n", header->version);
+		return -EINVAL;
+	}
+
+	num_ops = le16_to_cpu(header->count);
+	if (!num_ops || fw->size != sizeof(*header) + num_ops * sizeof(*op)) {
+		DRM_DEV_ERROR(dev, "Got MCS firmware of %zu bytes for %zu operations\n", fw->size, num_ops);
+		return -EINVAL;
+	}
+
+	entries = kcalloc(num_ops, sizeof(*entries), GFP_KERNEL);
+	if (!entries)
+		return -ENOMEM;
+
+	op = (const void *)(header + 1);
+	for (i = 0; i < num_ops; i++, op++) {
+		switch (op->opcode) {
+		case MCS_FW_OP_WRITE:
+		case MCS_FW_OP_WRITE_ORDERED:
+			entries[n].cmd = op->arg[0];
+			entries[n].param = op->arg[1];
+			entries[n].ordered = op->opcode == MCS_FW_OP_WRITE_ORDERED;
+			n++;
+			break;
+		case MCS_FW_OP_PAGE:
+			entries[n].cmd = MCS_PAGE_SELECT;
+			entries[n].param = op->arg[0];
+			n++;
+			break;
+		case MCS_FW_OP_DELAY:
+			if (!n || entries[n - 1].delay + op->arg[0] > U8_MAX) {
+				DRM_DEV_ERROR(dev, "Got invalid delay in MCS firmware operation %zu\n", i);
+				goto fail;
+			}
+			entries[n - 1].delay += op->arg[0];
+			break;
+		default:
+			DRM_DEV_ERROR(dev, "Got invalid opcode 0x%02x in MCS firmware operation %zu\n", op->opcode, i);
+			goto fail;
+		}
+	}
+
+	*cmd_set = entries;
+	*count = n;
+
+	return 0;
+
+fail:
+	kfree(entries);
+
+	return -EINVAL;
+}
+
+/**
+ * Dump the compiled MCS together with the modelled cost of a full power cycle.
+ */
+static void am4001280atzqw00h_dump_sequence(struct panel_driver_data *drv_data)
+{
+	const struct drm_panel_data *panel_data = drv_data->panel_data;
+	struct device *dev = &drv_data->dsi->dev;
+	u32 budget_ms;
+
+	budget_ms = panel_data->delay.prepare + panel_data->delay.enable +
+		    panel_data->delay.disable + panel_data->delay.unprepare + drv_data->mcs.delay_ms;
+	if (drv_data->reset_pin)
+		budget_ms += panel_data->delay.reset + panel_data->delay.reset_assert;
+
+	print_hex_dump_debug("mcs: ", DUMP_PREFIX_OFFSET, 16, 1, drv_data->mcs.buf, drv_data->mcs.len, false);
+
+	DRM_DEV_DEBUG_DRIVER(dev, "MCS takes %zu bytes in %u packets, a power cycle has %u ms of delays\n",
+			     drv_data->mcs.len, drv_data->mcs.packets, budget_ms);
+}
 
 /**
  *
@@ -332,23 +892,49 @@ static int color_format_from_dsi_format(enum mipi_dsi_pixel_format format)
 };
 
 /**
- * Instance of drm_display_mode.
+ * Base timing all modes are derived from, declared for "AM4001280_REFRESH".
+ * The pixel clock (in kHz) is the minimum that fits one frame per period.
+ */
+#define AM4001280_REFRESH	60
+#define AM4001280_HTOTAL	(400 + 30 + 5 + 40)
+#define AM4001280_VTOTAL	(1280 + 30 + 20 + 30)
+#define AM4001280_CLOCK		(AM4001280_HTOTAL * AM4001280_VTOTAL * AM4001280_REFRESH / 1000)
+
+/**
+ * Lines added to the vertical front porch so that a frame at the unchanged
+ * pixel clock takes 1/hz. Evaluated by the compiler, hz must divide evenly.
+ */
+#define AM4001280_VFP_EXTRA(hz)	(AM4001280_VTOTAL * AM4001280_REFRESH / (hz) - AM4001280_VTOTAL)
+
+/**
+ * Instance of drm_display_mode refreshing at hz.
+ */
+#define AM4001280_MODE(hz) {						\
+	.clock = AM4001280_CLOCK,					\
+	.hdisplay = 400,						\
+	.hsync_start = 400 + 30,					\
+	.hsync_end = 400 + 5 + 40,					\
+	.htotal = AM4001280_HTOTAL,					\
+	.vdisplay = 1280,						\
+	.vsync_start = 1280 + 30 + AM4001280_VFP_EXTRA(hz),		\
+	.vsync_end = 1280 + 20 + 30 + AM4001280_VFP_EXTRA(hz),		\
+	.vtotal = AM4001280_VTOTAL + AM4001280_VFP_EXTRA(hz),		\
+	.width_mm = 190,						\
+	.height_mm = 59,						\
+	.flags = DRM_MODE_FLAG_NHSYNC |					\
+		 DRM_MODE_FLAG_NVSYNC					\
+}
+
+/**
+ * Instances of drm_display_mode, the first one being the preferred mode.
+ * Lower rates cut the DSI link and host load for mostly static content.
  * Referenced by an instance of drm_panel_data.
  */
-static const struct drm_display_mode am4001280atzqw00h_mode = {
-	.clock = 200000, // 200000 is a good clock rate
-	.hdisplay = 400,
-	.hsync_start = 400 + 30,
-	.hsync_end = 400 + 5 + 40,
-	.htotal = 400 + 30 + 5 + 40,
-	.vdisplay = 1280,
-	.vsync_start = 1280 + 30,
-	.vsync_end = 1280 + 20 + 30,
-	.vtotal = 1280 + 30 + 20 + 30,
-	.width_mm = 190,
-	.height_mm = 59,
-	.flags = DRM_MODE_FLAG_NHSYNC |
-		 DRM_MODE_FLAG_NVSYNC
+static const struct drm_display_mode am4001280atzqw00h_modes[] = {
+	AM4001280_MODE(AM4001280_REFRESH),
+	AM4001280_MODE(50),
+	AM4001280_MODE(30),
+	AM4001280_MODE(24),
 };
 
 /**
@@ -358,7 +944,8 @@ static const struct drm_display_mode am4001280atzqw00h_mode = {
 static const struct drm_panel_data am4001280atzqw00h_data = {
 
 	/* Reference the display mode(s) initialized earlier. */
-	.modes = &am4001280atzqw00h_mode,
+	.modes = am4001280atzqw00h_modes,
+	.num_modes = ARRAY_SIZE(am4001280atzqw00h_modes),
 	.bpc = 8,
 	.size = {
 		.width = 59,
@@ -368,24 +955,39 @@ static const struct drm_panel_data am4001280atzqw00h_data = {
 		.x = 400,
 		.y = 1280
 	},
-	.refresh = 60,
-	.tearing_effect_support = false,
-	/*
+	.refresh = AM4001280_REFRESH,
+	/**
+	 * The panel datasheet specifies neither rate. These are the D-PHY v1.0
+	 * limits of 1 Gbit/s per lane in highspeed and 10 Mbit/s in LP mode,
+	 * "max-hs-rate-mbps" and "max-lp-rate-mbps" override them.
+	 */
+	.max_hs_rate = 1000,
+	.max_lp_rate = 10,
+	.tearing_effect_support = true,
 	.delay = {
-		.prepare = 1000,
-		.enable = 0,
-		.disable = 0,
+		.prepare = 10,
+		.reset = 50,
+		.reset_assert = 15,
+		.enable = 5,
+		.disable = 10,
+		/** No power-off time is specified for the panel, so none is enforced */
 		.unprepare = 0
 	},
-	*/
 	.bus_flags = DRM_BUS_FLAG_DE_LOW | DRM_BUS_FLAG_PIXDATA_DRIVE_NEGEDGE,
 	.connector_type = DRM_MODE_CONNECTOR_DSI
 };
 
-static const u32 am4001280atzqw00h_bus_formats[] = {
-	MEDIA_BUS_FMT_RGB888_1X24,
-	MEDIA_BUS_FMT_RGB666_1X18,
-	MEDIA_BUS_FMT_RGB565_1X16,
+/**
+ * Bus formats selectable through "bus-format" and the DSI pixel format carrying them.
+ * The first entry is the default.
+ */
+static const struct {
+	u32 bus_format;
+	enum mipi_dsi_pixel_format format;
+} am4001280atzqw00h_bus_formats[] = {
+	{ MEDIA_BUS_FMT_RGB888_1X24, MIPI_DSI_FMT_RGB888 },
+	{ MEDIA_BUS_FMT_RGB666_1X18, MIPI_DSI_FMT_RGB666_PACKED },
+	{ MEDIA_BUS_FMT_RGB565_1X16, MIPI_DSI_FMT_RGB565 },
 };
 
 /**
@@ -396,100 +998,872 @@ static const char * const am4001280atzqw00h_supply_names[] = {
 };
 
 /**
- * === Panel functions ===
- */
-
-/**
- * == DRM panel functions ==
+ * == Rotation ==
  */
 
 /**
- * 
+ * Turn the mounting rotation and mirroring into a scan direction and a reported orientation.
+ *
+ * Flipping both scan directions rotates by 180 degree on the panel itself.
+ * Swapping rows and columns would change the 400x1280 timing, so 90 and 270
+ * degree are left to userspace through the panel orientation property, see
+ * am4001280atzqw00h_get_orientation().
  */
-static int am4001280atzqw00h_prepare(struct drm_panel *panel)
+static int am4001280atzqw00h_set_rotation(struct panel_driver_data *drv_data, u32 rotation, bool flip_h, bool flip_v)
 {
-	struct panel_driver_data *drv_data = panel_to_drv_data(panel);
-	struct mipi_dsi_device *dsi = drv_data->dsi;
-	struct device *dev = &dsi->dev;
-	int ret;
-
-	if(drv_data->prepared) {
-		DRM_DEV_ERROR(dev, "Got call to prepare despite already being prepared (%d)\n", 1);
-		return 1;
-	}
-
-	/** Enable voltage/current regulator clients */
-	ret = regulator_bulk_enable(drv_data->num_supplies, drv_data->supplies);
-	if (ret < 0) {
-		DRM_DEV_ERROR(dev, "Failed to enable voltage/current regulators while preparing (%d)\n", ret);
-		return ret;
+	struct device *dev = &drv_data->dsi->dev;
+
+	drv_data->address_mode = 0;
+	drv_data->orientation = DRM_MODE_PANEL_ORIENTATION_NORMAL;
+
+	switch (rotation) {
+	case 0:
+		break;
+	case 90:
+		drv_data->orientation = DRM_MODE_PANEL_ORIENTATION_RIGHT_UP;
+		break;
+	case 180:
+		drv_data->address_mode = ADDRESS_MODE_FLIP_HORIZONTAL | ADDRESS_MODE_FLIP_VERTICAL;
+		break;
+	case 270:
+		drv_data->orientation = DRM_MODE_PANEL_ORIENTATION_LEFT_UP;
+		break;
+	default:
+		DRM_DEV_ERROR(dev, "Got invalid rotation during probe %u\n", rotation);
+		return -EINVAL;
 	}
 
-	/** At lest 10ms needed between power-on and reset-out */
-	usleep_range(10000, 12000);
-
-	if (drv_data->reset_pin) {
-		gpiod_set_value_cansleep(drv_data->reset_pin, 0);
+	if (flip_h)
+		drv_data->address_mode ^= ADDRESS_MODE_FLIP_HORIZONTAL;
+	if (flip_v)
+		drv_data->address_mode ^= ADDRESS_MODE_FLIP_VERTICAL;
 
-		/** 50ms delay after reset-out */
-		msleep(50);
-	}				
+	DRM_DEV_DEBUG_DRIVER(dev, "Rotation %u, address mode 0x%02x\n", rotation, drv_data->address_mode);
 
 	return 0;
 }
 
 /**
- * 
+ * Read the mounting rotation and mirroring from the device tree.
  */
-static int am4001280atzqw00h_unprepare(struct drm_panel *panel)
+static int am4001280atzqw00h_parse_rotation(struct panel_driver_data *drv_data, struct device_node *dev_node)
 {
-	struct panel_driver_data *drv_data = panel_to_drv_data(panel);
-	struct mipi_dsi_device *dsi = drv_data->dsi;
-	struct device *dev = &dsi->dev;
-	int ret;
+	u32 rotation = 0;
 
-	if(drv_data->prepared) {
-		DRM_DEV_ERROR(dev, "Got call to unprepare despite already not being prepared (%d)\n", 1);
-		return 1;
-	}
+	of_property_read_u32(dev_node, "rotation", &rotation);
 
-	if (drv_data->reset_pin) {
-		gpiod_set_value_cansleep(drv_data->reset_pin, 1);
-		usleep_range(15000, 17000);
-		gpiod_set_value_cansleep(drv_data->reset_pin, 0);
-	}
+	return am4001280atzqw00h_set_rotation(drv_data, rotation, of_property_read_bool(dev_node, "flip-horizontal"),
+					      of_property_read_bool(dev_node, "flip-vertical"));
+}
 
-	ret = regulator_bulk_disable(drv_data->num_supplies, drv_data->supplies);
-	if (ret < 0) {
-		DRM_DEV_ERROR(dev, "Failed to disable voltage/current regulators while unpreparing (%d)\n", ret);
-		return ret;
-	}
-	drv_data->prepared = false;
+/**
+ * == DSI link ==
+ */
 
-	return 0;
+/** Highest share of the link (in percent) the payload may take for burst mode to be picked */
+#define LINK_BURST_MAX_LOAD	50
+
+/**
+ * Per-lane DSI bit rate (in kbit/s) needed to carry a mode in the current format.
+ */
+static u64 am4001280atzqw00h_lane_rate(const struct mipi_dsi_device *dsi, const struct drm_display_mode *mode)
+{
+	return div_u64((u64)mode->clock * mipi_dsi_pixel_format_to_bpp(dsi->format), dsi->lanes);
 }
 
 /**
- *
+ * Check whether a mode stays within the highspeed rate of the panel.
  */
-static int am4001280atzqw00h_suspend(struct device *dev) 
+static bool am4001280atzqw00h_mode_fits(struct panel_driver_data *drv_data, const struct drm_display_mode *mode)
 {
-	struct panel_driver_data *drv_data = dev_get_drvdata(dev);
-	struct mipi_dsi_device *dsi = drv_data->dsi;
-	int ret;
+	return am4001280atzqw00h_lane_rate(drv_data->dsi, mode) <= (u64)drv_data->max_hs_rate * 1000;
+}
 
-	if(drv_data->suspended) {
-		DRM_DEV_ERROR(dev, "Got call to suspend despite already being suspended (%d)\n", 1);
-		return 1;
-	}
+/**
+ * Per-lane bit rate (in kbit/s) of the active pixels alone, without blanking.
+ */
+static u64 am4001280atzqw00h_payload_rate(const struct mipi_dsi_device *dsi, const struct drm_display_mode *mode)
+{
+	u64 rate = am4001280atzqw00h_lane_rate(dsi, mode) * mode->hdisplay * mode->vdisplay;
 
-	ret = mipi_dsi_dcs_enter_sleep_mode(dsi);
-	if (ret < 0) {
-		DRM_DEV_ERROR(dev, "Failed to enter sleep mode (%d)\n", ret);
-		return ret;
-	}
+	return div_u64(rate, mode->htotal * mode->vtotal);
+}
 
-	return 0;
+/**
+ * Share of the highspeed rate (in percent) the active pixels need.
+ */
+static u32 am4001280atzqw00h_link_load(struct panel_driver_data *drv_data)
+{
+	const struct drm_display_mode *mode = &drv_data->panel_data->modes[0];
+	u64 rate = am4001280atzqw00h_payload_rate(drv_data->dsi, mode);
+
+	return div_u64(rate * 100, drv_data->max_hs_rate * 1000);
+}
+
+/**
+ * Pick the video mode when the device tree leaves it open.
+ *
+ * Burst mode sends each line at the full highspeed rate and lets the lanes
+ * drop to LP for the rest of it, which only pays off when the payload leaves
+ * enough of the line time over. Otherwise non-burst with sync events is kept.
+ */
+static void am4001280atzqw00h_select_video_mode(struct panel_driver_data *drv_data)
+{
+	struct mipi_dsi_device *dsi = drv_data->dsi;
+	u32 load = am4001280atzqw00h_link_load(drv_data);
+
+	if (load <= LINK_BURST_MAX_LOAD) {
+		dsi->mode_flags |= MIPI_DSI_MODE_VIDEO_BURST;
+		DRM_DEV_INFO(&dsi->dev, "Selected burst mode, payload takes %u%% of the link\n", load);
+	} else {
+		DRM_DEV_INFO(&dsi->dev, "Selected non-burst mode, payload takes %u%% of the link\n", load);
+	}
+}
+
+/**
+ * Validate the preferred mode against the link and report its per-lane bit rate.
+ */
+static int am4001280atzqw00h_check_link(struct panel_driver_data *drv_data)
+{
+	struct mipi_dsi_device *dsi = drv_data->dsi;
+	const struct drm_display_mode *mode = &drv_data->panel_data->modes[0];
+	u64 rate = am4001280atzqw00h_lane_rate(dsi, mode);
+
+	if (!am4001280atzqw00h_mode_fits(drv_data, mode)) {
+		DRM_DEV_ERROR(&dsi->dev, "Failed to fit %llu kbit/s per lane into %u Mbit/s (%d)\n",
+			      rate, drv_data->max_hs_rate, -EINVAL);
+		return -EINVAL;
+	}
+
+	DRM_DEV_INFO(&dsi->dev, "Link runs at %llu kbit/s per lane for %ux%u@%u on %u lanes\n",
+		     rate, mode->hdisplay, mode->vdisplay, drm_mode_vrefresh(mode), dsi->lanes);
+
+	return 0;
+}
+
+/**
+ * == Brightness mapping ==
+ */
+
+/**
+ * Map a brightness level to the value sent to the panel.
+ */
+static u16 am4001280atzqw00h_brightness_to_raw(struct panel_driver_data *drv_data, int level)
+{
+	if (drv_data->bl_lut)
+		return drv_data->bl_lut[clamp_t(int, level, 0, drv_data->bl_levels - 1)];
+
+	return level;
+}
+
+/**
+ * Write a brightness level to the panel.
+ *
+ * In extended range mode the value is sent as two bytes, most significant
+ * byte first, like the large DCS brightness commands do.
+ */
+static int am4001280atzqw00h_write_brightness(struct panel_driver_data *drv_data, int level)
+{
+	struct mipi_dsi_device *dsi = drv_data->dsi;
+	u16 raw = am4001280atzqw00h_brightness_to_raw(drv_data, level);
+	u8 payload[2] = { raw >> 8, raw & 0xff };
+
+	if (!drv_data->bl_16bit)
+		return mipi_dsi_dcs_set_display_brightness(dsi, raw);
+
+	return mipi_dsi_dcs_write(dsi, MIPI_DCS_SET_DISPLAY_BRIGHTNESS, payload, sizeof(payload));
+}
+
+/**
+ * Read the brightness value back from the panel.
+ */
+static int am4001280atzqw00h_read_brightness(struct panel_driver_data *drv_data, u16 *raw)
+{
+	struct mipi_dsi_device *dsi = drv_data->dsi;
+	u8 payload[2];
+	int ret;
+
+	if (!drv_data->bl_16bit) {
+		ret = mipi_dsi_dcs_get_display_brightness(dsi, raw);
+		*raw &= 0xff;
+		return ret;
+	}
+
+	ret = mipi_dsi_dcs_read(dsi, MIPI_DCS_GET_DISPLAY_BRIGHTNESS, payload, sizeof(payload));
+	if (ret < 0)
+		return ret;
+
+	*raw = (payload[0] << 8) | payload[1];
+
+	return 0;
+}
+
+/**
+ * Set up the brightness range and the optional level table from the DT.
+ *
+ * Without a table the levels are sent as they are, ranging up to 255 or
+ * 65535 in extended range mode, "default-brightness-level" applying to
+ * either. A "brightness-levels" table of panel
+ * values is precomputed once so update_status only has to look it up.
+ */
+static int am4001280atzqw00h_parse_brightness(struct panel_driver_data *drv_data, struct backlight_properties *bl_props)
+{
+	struct device *dev = &drv_data->dsi->dev;
+	struct device_node *dev_node = dev->of_node;
+	u32 raw_max;
+	u32 level;
+	int count;
+	int ret;
+	int i;
+
+	drv_data->bl_16bit = of_property_read_bool(dev_node, "brightness-16bit");
+	raw_max = drv_data->bl_16bit ? U16_MAX : 255;
+
+	/** Default to 200 of 255, scaled to the extended range */
+	bl_props->max_brightness = raw_max;
+	bl_props->brightness = DIV_ROUND_CLOSEST(raw_max * 200, 255);
+
+	count = of_property_count_u32_elems(dev_node, "brightness-levels");
+	if (count <= 0) {
+		if (!of_property_read_u32(dev_node, "default-brightness-level", &level))
+			bl_props->brightness = min_t(u32, level, raw_max);
+		return 0;
+	}
+	if (count < 2) {
+		DRM_DEV_ERROR(dev, "Got too few brightness levels during probe %d\n", count);
+		return -EINVAL;
+	}
+
+	drv_data->bl_lut = devm_kcalloc(dev, count, sizeof(*drv_data->bl_lut), GFP_KERNEL);
+	if (!drv_data->bl_lut)
+		return -ENOMEM;
+
+	ret = of_property_read_u32_array(dev_node, "brightness-levels", drv_data->bl_lut, count);
+	if (ret < 0) {
+		DRM_DEV_ERROR(dev, "Failed to read brightness levels during probe (%d)\n", ret);
+		return ret;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (drv_data->bl_lut[i] > raw_max) {
+			DRM_DEV_ERROR(dev, "Got brightness level %u out of range during probe\n", drv_data->bl_lut[i]);
+			return -EINVAL;
+		}
+	}
+
+	drv_data->bl_levels = count;
+	bl_props->max_brightness = count - 1;
+	bl_props->brightness = count - 1;
+
+	if (!of_property_read_u32(dev_node, "default-brightness-level", &level))
+		bl_props->brightness = min_t(u32, level, count - 1);
+
+	return 0;
+}
+
+/**
+ * == Tearing effect ==
+ */
+
+/**
+ * Timestamp a rising edge of the TE line, marking the start of vblank.
+ */
+static irqreturn_t am4001280atzqw00h_te_irq(int irq, void *data)
+{
+	struct panel_driver_data *drv_data = data;
+	ktime_t now = ktime_get();
+
+	spin_lock(&drv_data->te_lock);
+	if (drv_data->te_count)
+		drv_data->te_period_us = ktime_us_delta(now, drv_data->te_timestamp);
+	drv_data->te_timestamp = now;
+	drv_data->te_count++;
+	spin_unlock(&drv_data->te_lock);
+
+	wake_up_all(&drv_data->te_wait);
+
+	return IRQ_HANDLED;
+}
+
+/**
+ * Wait for the next TE edge, so the caller runs at the start of vblank.
+ *
+ * Returns immediately if there is no TE line or the panel is not scanning
+ * out, and gives up after two frame periods.
+ */
+static void am4001280atzqw00h_te_sync(struct panel_driver_data *drv_data)
+{
+	unsigned long count = READ_ONCE(drv_data->te_count);
+
+	if (!drv_data->te_gpio || !drv_data->enabled)
+		return;
+
+	wait_event_timeout(drv_data->te_wait, READ_ONCE(drv_data->te_count) != count,
+			   msecs_to_jiffies(2 * MSEC_PER_SEC / drv_data->panel_data->refresh + 1));
+}
+
+/**
+ * Get the timestamp of the last vblank signalled by the panel.
+ *
+ * Returns the number of vblanks seen so far, or -ENODEV without a TE line.
+ */
+long am4001280atzqw00h_get_vblank_timestamp(struct drm_panel *panel, ktime_t *timestamp)
+{
+	struct panel_driver_data *drv_data = panel_to_drv_data(panel);
+	unsigned long flags;
+	long count;
+
+	if (!drv_data->te_gpio)
+		return -ENODEV;
+
+	spin_lock_irqsave(&drv_data->te_lock, flags);
+	*timestamp = drv_data->te_timestamp;
+	count = drv_data->te_count;
+	spin_unlock_irqrestore(&drv_data->te_lock, flags);
+
+	return count;
+}
+EXPORT_SYMBOL_GPL(am4001280atzqw00h_get_vblank_timestamp);
+
+/**
+ * Request the optional TE line and its interrupt.
+ */
+static int am4001280atzqw00h_te_init(struct panel_driver_data *drv_data)
+{
+	struct device *dev = &drv_data->dsi->dev;
+	int irq;
+	int ret;
+
+	init_waitqueue_head(&drv_data->te_wait);
+	spin_lock_init(&drv_data->te_lock);
+
+	if (!drv_data->panel_data->tearing_effect_support)
+		return 0;
+
+	drv_data->te_gpio = devm_gpiod_get_optional(dev, "te", GPIOD_IN);
+	if (IS_ERR(drv_data->te_gpio)) {
+		ret = PTR_ERR(drv_data->te_gpio);
+		DRM_DEV_ERROR(dev, "Failed get TE pin during probe (%d)\n", ret);
+		return ret;
+	}
+	if (!drv_data->te_gpio)
+		return 0;
+
+	irq = gpiod_to_irq(drv_data->te_gpio);
+	if (irq < 0) {
+		DRM_DEV_ERROR(dev, "Failed to get TE interrupt during probe (%d)\n", irq);
+		return irq;
+	}
+
+	ret = devm_request_irq(dev, irq, am4001280atzqw00h_te_irq, IRQF_TRIGGER_RISING, dev_name(dev), drv_data);
+	if (ret < 0) {
+		DRM_DEV_ERROR(dev, "Failed to request TE interrupt during probe (%d)\n", ret);
+		return ret;
+	}
+
+	return 0;
+}
+
+/**
+ * == Runtime PM references ==
+ */
+
+/**
+ * Take a runtime PM reference, waking the panel if it went idle.
+ */
+static int am4001280atzqw00h_pm_get(struct device *dev)
+{
+	int ret;
+
+	ret = pm_runtime_get_sync(dev);
+	if (ret < 0) {
+		pm_runtime_put_noidle(dev);
+		DRM_DEV_ERROR(dev, "Failed to resume panel (%d)\n", ret);
+		return ret;
+	}
+
+	return 0;
+}
+
+/**
+ * Drop a runtime PM reference, restarting the autosuspend timer.
+ */
+static void am4001280atzqw00h_pm_put(struct device *dev)
+{
+	pm_runtime_mark_last_busy(dev);
+	pm_runtime_put_autosuspend(dev);
+}
+
+/**
+ * == Latency statistics ==
+ */
+
+static const char * const latency_op_names[LATENCY_OP_COUNT] = {
+	[LATENCY_PREPARE] = "prepare",
+	[LATENCY_ENABLE] = "enable",
+	[LATENCY_DISABLE] = "disable",
+	[LATENCY_UNPREPARE] = "unprepare",
+	[LATENCY_BL_UPDATE] = "backlight_update_status",
+	[LATENCY_BL_GET] = "backlight_get_brightness",
+};
+
+/**
+ * Account the latency of an operation that started at "start".
+ */
+static void latency_stats_record(struct panel_driver_data *drv_data, enum latency_op op, ktime_t start)
+{
+	struct latency_stats *stats = &drv_data->stats[op];
+	s64 delta_us = ktime_us_delta(ktime_get(), start);
+	u64 us = delta_us > 0 ? delta_us : 0;
+
+	spin_lock(&drv_data->stats_lock);
+
+	if (!stats->count || us < stats->min_us)
+		stats->min_us = us;
+	if (us > stats->max_us)
+		stats->max_us = us;
+	stats->count++;
+	stats->total_us += us;
+	stats->hist[min_t(int, fls64(us), LATENCY_HIST_BUCKETS - 1)]++;
+
+	spin_unlock(&drv_data->stats_lock);
+}
+
+/**
+ * Print the statistics of all operations to the "stats" debugfs file.
+ */
+static int latency_stats_show(struct seq_file *m, void *data)
+{
+	struct panel_driver_data *drv_data = m->private;
+	struct latency_stats stats;
+	int op, i;
+
+	for (op = 0; op < LATENCY_OP_COUNT; op++) {
+		spin_lock(&drv_data->stats_lock);
+		stats = drv_data->stats[op];
+		spin_unlock(&drv_data->stats_lock);
+
+		seq_printf(m, "%s: count=%llu min=%lluus max=%lluus mean=%lluus\n",
+			   latency_op_names[op], stats.count, stats.min_us, stats.max_us,
+			   stats.count ? div64_u64(stats.total_us, stats.count) : 0);
+
+		for (i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+			if (!stats.hist[i])
+				continue;
+
+			if (!i)
+				seq_printf(m, "  [0us, 1us): %u\n", stats.hist[i]);
+			else if (i == LATENCY_HIST_BUCKETS - 1)
+				seq_printf(m, "  [%luus, inf): %u\n", BIT(i - 1), stats.hist[i]);
+			else
+				seq_printf(m, "  [%luus, %luus): %u\n", BIT(i - 1), BIT(i), stats.hist[i]);
+		}
+	}
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(latency_stats);
+
+/**
+ * Clear all statistics on any write to the "reset" debugfs file.
+ */
+static ssize_t latency_stats_reset_write(struct file *file, const char __user *buf, size_t count, loff_t *ppos)
+{
+	struct panel_driver_data *drv_data = file->private_data;
+
+	spin_lock(&drv_data->stats_lock);
+	memset(drv_data->stats, 0, sizeof(drv_data->stats));
+	spin_unlock(&drv_data->stats_lock);
+
+	return count;
+}
+
+static const struct file_operations latency_stats_reset_fops = {
+	.owner = THIS_MODULE,
+	.open = simple_open,
+	.write = latency_stats_reset_write,
+	.llseek = noop_llseek,
+};
+
+/**
+ * Read the brightness back from the panel and compare it to the cached value.
+ */
+static int brightness_verify_show(struct seq_file *m, void *data)
+{
+	struct panel_driver_data *drv_data = m->private;
+	struct mipi_dsi_device *dsi = drv_data->dsi;
+	int cached = READ_ONCE(drv_data->bl_actual);
+	u16 expected = am4001280atzqw00h_brightness_to_raw(drv_data, cached);
+	u16 brightness;
+	int ret;
+
+	ret = am4001280atzqw00h_pm_get(&dsi->dev);
+	if (ret < 0)
+		return ret;
+
+	if (!drv_data->prepared) {
+		seq_printf(m, "cached=%d panel=unavailable\n", cached);
+		goto out;
+	}
+
+	ret = am4001280atzqw00h_read_brightness(drv_data, &brightness);
+	trace_am4001280_dcs(dsi, MIPI_DCS_GET_DISPLAY_BRIGHTNESS, ret);
+	if (ret < 0) {
+		dev_err(&dsi->dev, "Failed to get backlight brightness.(%d)\n", ret);
+		goto out;
+	}
+
+	seq_printf(m, "cached=%d expected=%u panel=%u %s\n", cached, expected, brightness,
+		   brightness == expected ? "ok" : "mismatch");
+
+out:
+	am4001280atzqw00h_pm_put(&dsi->dev);
+
+	return ret < 0 ? ret : 0;
+}
+DEFINE_SHOW_ATTRIBUTE(brightness_verify);
+
+/**
+ * Print the vblank count, the last TE timestamp and the measured frame period.
+ */
+static int te_show(struct seq_file *m, void *data)
+{
+	struct panel_driver_data *drv_data = m->private;
+	unsigned long count;
+	ktime_t timestamp;
+	s64 period_us;
+
+	spin_lock_irq(&drv_data->te_lock);
+	count = drv_data->te_count;
+	timestamp = drv_data->te_timestamp;
+	period_us = drv_data->te_period_us;
+	spin_unlock_irq(&drv_data->te_lock);
+
+	seq_printf(m, "count=%lu timestamp=%lldns period=%lldus\n", count, ktime_to_ns(timestamp), period_us);
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(te);
+
+/**
+ * Print the link configuration and how the video mode was chosen.
+ */
+static int link_show(struct seq_file *m, void *data)
+{
+	struct panel_driver_data *drv_data = m->private;
+	struct mipi_dsi_device *dsi = drv_data->dsi;
+	const struct drm_display_mode *mode = &drv_data->panel_data->modes[0];
+	const char *video_mode;
+
+	if (drv_data->command_mode)
+		video_mode = "command";
+	else if (dsi->mode_flags & MIPI_DSI_MODE_VIDEO_BURST)
+		video_mode = "burst";
+	else if (dsi->mode_flags & MIPI_DSI_MODE_VIDEO_SYNC_PULSE)
+		video_mode = "non-burst sync pulse";
+	else
+		video_mode = "non-burst sync event";
+
+	seq_printf(m, "lanes=%u bpp=%d clock=%dkHz\n", dsi->lanes, mipi_dsi_pixel_format_to_bpp(dsi->format), mode->clock);
+	seq_printf(m, "lane_rate=%llukbps payload_rate=%llukbps max_hs_rate=%uMbps load=%u%%\n",
+		   am4001280atzqw00h_lane_rate(dsi, mode), am4001280atzqw00h_payload_rate(dsi, mode),
+		   drv_data->max_hs_rate, am4001280atzqw00h_link_load(drv_data));
+	seq_printf(m, "video_mode=%s (%s)\n", video_mode, drv_data->video_mode_auto ? "auto" : "device tree");
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(link);
+
+/**
+ * Print the entries the optimiser dropped from the MCS, one per line.
+ */
+static int mcs_optimised_show(struct seq_file *m, void *data)
+{
+	static const char * const reasons[] = {
+		[MCS_DROP_SUPERSEDED] = "superseded",
+		[MCS_DROP_PAGE_SELECT] = "page select without effect",
+	};
+	struct panel_driver_data *drv_data = m->private;
+	const struct mcs_report *report = &drv_data->mcs_report;
+	size_t i;
+
+	mutex_lock(&drv_data->mcs_lock);
+
+	seq_printf(m, "entries=%zu kept=%zu dropped=%zu packets=%u\n", report->entries,
+		   report->entries - report->num_dropped, report->num_dropped, drv_data->mcs.packets);
+
+	for (i = 0; i < report->num_dropped; i++) {
+		const struct mcs_drop *drop = &report->dropped[i];
+
+		seq_printf(m, "-[%zu] page %d 0x%02x=0x%02x %s\n", drop->index, drop->page,
+			   drop->entry.cmd, drop->entry.param, reasons[drop->reason]);
+	}
+
+	mutex_unlock(&drv_data->mcs_lock);
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(mcs_optimised);
+
+/**
+ * Create the debugfs directory of a panel instance.
+ */
+static void am4001280atzqw00h_debugfs_init(struct panel_driver_data *drv_data)
+{
+	struct device *dev = &drv_data->dsi->dev;
+	char name[64];
+
+	snprintf(name, sizeof(name), "am4001280-%s", dev_name(dev));
+	drv_data->debugfs = debugfs_create_dir(name, NULL);
+
+	debugfs_create_file("stats", 0444, drv_data->debugfs, drv_data, &latency_stats_fops);
+	debugfs_create_file("reset", 0200, drv_data->debugfs, drv_data, &latency_stats_reset_fops);
+	debugfs_create_file("verify_brightness", 0444, drv_data->debugfs, drv_data, &brightness_verify_fops);
+	debugfs_create_file("link", 0444, drv_data->debugfs, drv_data, &link_fops);
+	if (drv_data->mcs_optimise)
+		debugfs_create_file("mcs_optimised", 0444, drv_data->debugfs, drv_data, &mcs_optimised_fops);
+	if (drv_data->te_gpio)
+		debugfs_create_file("te", 0444, drv_data->debugfs, drv_data, &te_fops);
+}
+
+/**
+ * === Panel functions ===
+ */
+
+/**
+ * == DRM panel functions ==
+ */
+
+/**
+ * Sleep for a delay given in milliseconds.
+ *
+ * Short delays use a 2ms slack range, longer ones fall back to msleep.
+ * The delay is accounted in the sleep budget of the running sequence.
+ */
+static void am4001280atzqw00h_delay(struct panel_driver_data *drv_data, u32 ms)
+{
+	ktime_t start;
+
+	if (!ms)
+		return;
+
+	drv_data->sleep_budget_ms += ms;
+	start = ktime_get();
+
+	if (ms < 20)
+		usleep_range(ms * 1000, ms * 1000 + 2000);
+	else
+		msleep(ms);
+
+	trace_am4001280_sleep(&drv_data->dsi->dev, ms * 1000, ktime_us_delta(ktime_get(), start));
+}
+
+/**
+ * Wait for whatever is left of the power-off time of the last unprepare.
+ */
+static void am4001280atzqw00h_hw_guard(struct panel_driver_data *drv_data)
+{
+	ktime_t start = ktime_get();
+	s64 remaining_us = ktime_us_delta(drv_data->hw_guard_end, start);
+
+	if (remaining_us <= 0)
+		return;
+
+	DRM_DEV_DEBUG_DRIVER(&drv_data->dsi->dev, "Waiting %lld us for the panel to power down\n", remaining_us);
+	drv_data->sleep_budget_ms += DIV_ROUND_UP(remaining_us, 1000);
+
+	if (remaining_us < 20 * USEC_PER_MSEC)
+		usleep_range(remaining_us, remaining_us + 1000);
+	else
+		msleep(DIV_ROUND_UP(remaining_us, USEC_PER_MSEC));
+
+	trace_am4001280_sleep(&drv_data->dsi->dev, remaining_us, ktime_us_delta(ktime_get(), start));
+}
+
+/**
+ * Power the panel up and release it from reset.
+ */
+static int am4001280atzqw00h_power_on(struct panel_driver_data *drv_data)
+{
+	struct device *dev = &drv_data->dsi->dev;
+	int ret;
+
+	drv_data->mcs_retained = false;
+	drv_data->idle = false;
+	drv_data->sleep_budget_ms = 0;
+
+	am4001280atzqw00h_hw_guard(drv_data);
+
+	/** Enable voltage/current regulator clients */
+	ret = regulator_bulk_enable(drv_data->num_supplies, drv_data->supplies);
+	if (ret < 0) {
+		DRM_DEV_ERROR(dev, "Failed to enable voltage/current regulators while preparing (%d)\n", ret);
+		return ret;
+	}
+
+	/** Delay needed between power-on and reset-out */
+	am4001280atzqw00h_delay(drv_data, drv_data->panel_data->delay.prepare);
+
+	if (drv_data->reset_pin) {
+		gpiod_set_value_cansleep(drv_data->reset_pin, 0);
+
+		/** Delay after reset-out */
+		am4001280atzqw00h_delay(drv_data, drv_data->panel_data->delay.reset);
+	}				
+
+	drv_data->prepared = true;
+	trace_am4001280_state(dev, "prepared", true);
+
+	DRM_DEV_DEBUG_DRIVER(dev, "Prepared with %u ms of delays\n", drv_data->sleep_budget_ms);
+
+	return 0;
+}
+
+/**
+ * Put the panel into reset and cut its supply.
+ */
+static int am4001280atzqw00h_power_off(struct panel_driver_data *drv_data)
+{
+	struct device *dev = &drv_data->dsi->dev;
+	int ret;
+
+	/** The panel loses its registers from here on */
+	drv_data->mcs_retained = false;
+
+	if (drv_data->reset_pin) {
+		gpiod_set_value_cansleep(drv_data->reset_pin, 1);
+		am4001280atzqw00h_delay(drv_data, drv_data->panel_data->delay.reset_assert);
+		gpiod_set_value_cansleep(drv_data->reset_pin, 0);
+	}
+
+	ret = regulator_bulk_disable(drv_data->num_supplies, drv_data->supplies);
+	if (ret < 0) {
+		DRM_DEV_ERROR(dev, "Failed to disable voltage/current regulators while powering off (%d)\n", ret);
+		return ret;
+	}
+
+	/** Keep the next prepare from starting before the panel powered down */
+	drv_data->hw_guard_end = ktime_add_ms(ktime_get(), drv_data->hw_guard_wait);
+
+	return 0;
+}
+
+/**
+ * Work item running the power-up sequence of an asynchronous prepare.
+ */
+static void am4001280atzqw00h_prepare_work(struct work_struct *work)
+{
+	struct panel_driver_data *drv_data = container_of(work, struct panel_driver_data, prepare_work);
+
+	drv_data->prepare_ret = am4001280atzqw00h_power_on(drv_data);
+	complete_all(&drv_data->prepare_done);
+}
+
+/**
+ * Wait for an asynchronous prepare in flight and return its result.
+ *
+ * The panel callbacks, the brightness flush work and the runtime and system
+ * suspend call this before touching the panel. The backlight ops don't, they
+ * only record the brightness and leave the write to the flush work.
+ */
+static int am4001280atzqw00h_wait_ready(struct panel_driver_data *drv_data)
+{
+	if (!drv_data->async_prepare)
+		return 0;
+
+	wait_for_completion(&drv_data->prepare_done);
+
+	return drv_data->prepare_ret;
+}
+
+/**
+ * 
+ */
+static int __am4001280atzqw00h_prepare(struct drm_panel *panel)
+{
+	struct panel_driver_data *drv_data = panel_to_drv_data(panel);
+	struct mipi_dsi_device *dsi = drv_data->dsi;
+	struct device *dev = &dsi->dev;
+
+	am4001280atzqw00h_wait_ready(drv_data);
+
+	/** The panel was adopted live from the bootloader */
+	if (drv_data->handed_off)
+		return 0;
+
+	if(drv_data->prepared) {
+		DRM_DEV_ERROR(dev, "Got call to prepare despite already being prepared (%d)\n", 1);
+		return 1;
+	}
+
+	if (!drv_data->async_prepare)
+		return am4001280atzqw00h_power_on(drv_data);
+
+	/** Overlap the power-up delays with the rest of the pipeline setup */
+	reinit_completion(&drv_data->prepare_done);
+	queue_work(drv_data->wq, &drv_data->prepare_work);
+
+	return 0;
+}
+
+/**
+ * 
+ */
+static int __am4001280atzqw00h_unprepare(struct drm_panel *panel)
+{
+	struct panel_driver_data *drv_data = panel_to_drv_data(panel);
+	struct mipi_dsi_device *dsi = drv_data->dsi;
+	struct device *dev = &dsi->dev;
+	int ret;
+
+	am4001280atzqw00h_wait_ready(drv_data);
+
+	if(!drv_data->prepared) {
+		DRM_DEV_ERROR(dev, "Got call to unprepare despite already not being prepared (%d)\n", 1);
+		return 1;
+	}
+
+	if (drv_data->idle_off) {
+		/** Runtime PM already powered the panel down, the next resume has nothing to restore */
+		drv_data->idle_off = false;
+		trace_am4001280_state(dev, "idle_off", false);
+	} else {
+		ret = am4001280atzqw00h_power_off(drv_data);
+		if (ret < 0)
+			return ret;
+	}
+
+	drv_data->prepared = false;
+	drv_data->handed_off = false;
+	trace_am4001280_state(dev, "prepared", false);
+
+	return 0;
+}
+
+/**
+ *
+ */
+static int am4001280atzqw00h_suspend(struct device *dev) 
+{
+	struct panel_driver_data *drv_data = dev_get_drvdata(dev);
+	struct mipi_dsi_device *dsi = drv_data->dsi;
+	int ret;
+
+	if(drv_data->suspended) {
+		DRM_DEV_ERROR(dev, "Got call to suspend despite already being suspended (%d)\n", 1);
+		return 1;
+	}
+
+	ret = mipi_dsi_dcs_enter_sleep_mode(dsi);
+	trace_am4001280_dcs(dsi, MIPI_DCS_ENTER_SLEEP_MODE, ret);
+	if (ret < 0) {
+		DRM_DEV_ERROR(dev, "Failed to enter sleep mode (%d)\n", ret);
+		return ret;
+	}
+	drv_data->suspended = true;
+	trace_am4001280_state(dev, "suspended", true);
+
+	return 0;
 }
 
 /**
@@ -497,32 +1871,449 @@ static int am4001280atzqw00h_suspend(struct device *dev)
  */
 static int am4001280atzqw00h_resume(struct device *dev)
 {
-	struct panel_driver_data *drv_data = dev_get_drvdata(dev);
-	struct mipi_dsi_device *dsi = drv_data->dsi;
+	struct panel_driver_data *drv_data = dev_get_drvdata(dev);
+	struct mipi_dsi_device *dsi = drv_data->dsi;
+	int ret;
+
+	if(!drv_data->suspended) {
+		DRM_DEV_ERROR(dev, "Got call to resume despite not being suspended (%d)\n", 1);
+		return 1;
+	}
+
+	ret = mipi_dsi_dcs_exit_sleep_mode(dsi);
+	trace_am4001280_dcs(dsi, MIPI_DCS_EXIT_SLEEP_MODE, ret);
+	if (ret < 0) {
+		DRM_DEV_ERROR(dev, "Failed to exit sleep mode (%d)\n", ret);
+		return ret;
+	}
+	drv_data->suspended = false;
+	trace_am4001280_state(dev, "suspended", false);
+
+	return 0;
+}
+
+/**
+ * == Idle mode ==
+ */
+
+/**
+ * Enter or leave the reduced colour and refresh idle mode of the panel.
+ */
+static int am4001280atzqw00h_set_idle(struct panel_driver_data *drv_data, bool idle)
+{
+	struct mipi_dsi_device *dsi = drv_data->dsi;
+	struct device *dev = &dsi->dev;
+	u8 cmd = idle ? MIPI_DCS_ENTER_IDLE_MODE : MIPI_DCS_EXIT_IDLE_MODE;
+	int ret;
+
+	lockdep_assert_held(&drv_data->lock);
+
+	if (drv_data->idle == idle)
+		return 0;
+
+	ret = mipi_dsi_dcs_write(dsi, cmd, NULL, 0);
+	trace_am4001280_dcs(dsi, cmd, ret);
+	if (ret < 0) {
+		DRM_DEV_ERROR(dev, "Failed to %s idle mode (%d)\n", idle ? "enter" : "exit", ret);
+		return ret;
+	}
+
+	drv_data->idle = idle;
+	trace_am4001280_state(dev, "idle", idle);
+
+	return 0;
+}
+
+/**
+ * Work item entering idle mode once the content stayed static for the timeout.
+ */
+static void am4001280atzqw00h_idle_work(struct work_struct *work)
+{
+	struct panel_driver_data *drv_data = container_of(to_delayed_work(work), struct panel_driver_data, idle_work);
+	struct device *dev = &drv_data->dsi->dev;
+
+	/** No point in waking a panel runtime PM powered down */
+	if (drv_data->idle_off)
+		return;
+
+	if (am4001280atzqw00h_pm_get(dev) < 0)
+		return;
+
+	mutex_lock(&drv_data->lock);
+	if (drv_data->enabled)
+		am4001280atzqw00h_set_idle(drv_data, true);
+	mutex_unlock(&drv_data->lock);
+
+	am4001280atzqw00h_pm_put(dev);
+}
+
+/**
+ * Note new content, leaving idle mode and restarting the inactivity timeout.
+ */
+static void am4001280atzqw00h_activity(struct panel_driver_data *drv_data)
+{
+	if (!drv_data->idle_timeout_ms)
+		return;
+
+	mutex_lock(&drv_data->lock);
+	am4001280atzqw00h_set_idle(drv_data, false);
+	mutex_unlock(&drv_data->lock);
+
+	mod_delayed_work(drv_data->wq, &drv_data->idle_work, msecs_to_jiffies(drv_data->idle_timeout_ms));
+}
+
+/**
+ * Stop the inactivity timeout and leave idle mode.
+ */
+static void am4001280atzqw00h_idle_stop(struct panel_driver_data *drv_data)
+{
+	if (!drv_data->idle_timeout_ms)
+		return;
+
+	cancel_delayed_work_sync(&drv_data->idle_work);
+
+	mutex_lock(&drv_data->lock);
+	am4001280atzqw00h_set_idle(drv_data, false);
+	mutex_unlock(&drv_data->lock);
+}
+
+/**
+ * Report damage from an atomic commit in command mode, taking the panel out of idle mode.
+ */
+void am4001280atzqw00h_notify_damage(struct drm_panel *panel)
+{
+	struct panel_driver_data *drv_data = panel_to_drv_data(panel);
+
+	if (am4001280atzqw00h_pm_get(panel->dev) < 0)
+		return;
+
+	if (drv_data->enabled)
+		am4001280atzqw00h_activity(drv_data);
+
+	am4001280atzqw00h_pm_put(panel->dev);
+}
+EXPORT_SYMBOL_GPL(am4001280atzqw00h_notify_damage);
+
+/**
+ * 
+ */
+static int __am4001280atzqw00h_enable(struct drm_panel *panel)
+{
+	struct panel_driver_data *drv_data = panel_to_drv_data(panel);
+	int ret;
+
+	ret = am4001280atzqw00h_wait_ready(drv_data);
+	if (ret < 0) {
+		DRM_DEV_ERROR(panel->dev, "Failed to prepare panel before enabling (%d)\n", ret);
+		return ret;
+	}
+
+	/** The panel was adopted live from the bootloader and already shows its frame */
+	if (drv_data->handed_off) {
+		drv_data->handed_off = false;
+		return 0;
+	}
+
+	/** Keep the panel from autosuspending while it shows video, dropped on disable */
+	ret = am4001280atzqw00h_pm_get(panel->dev);
+	if (ret < 0)
+		return ret;
+
+	ret = drv_data->pl_data->enable(drv_data);
+	if (ret) {
+		am4001280atzqw00h_pm_put(panel->dev);
+		return ret;
+	}
+
+	backlight_enable(drv_data->bl_dev);
+
+	am4001280atzqw00h_activity(drv_data);
+
+	return 0;
+}
+
+/**
+ * Try to adopt a panel the bootloader already brought up.
+ *
+ * The supply is claimed and the DCS power mode is read. A panel that is out
+ * of sleep with its display on is taken over as prepared and enabled without
+ * any sequencing, anything else is powered down like on a regular probe.
+ */
+static bool am4001280atzqw00h_adopt(struct panel_driver_data *drv_data)
+{
+	struct mipi_dsi_device *dsi = drv_data->dsi;
+	struct device *dev = &dsi->dev;
+	unsigned long mode_flags = dsi->mode_flags;
+	u8 power_mode;
+	int ret;
+
+	ret = regulator_bulk_enable(drv_data->num_supplies, drv_data->supplies);
+	if (ret < 0) {
+		DRM_DEV_ERROR(dev, "Failed to enable voltage/current regulators while adopting panel (%d)\n", ret);
+		goto reset;
+	}
+
+	dsi->mode_flags |= MIPI_DSI_MODE_LPM;
+	ret = mipi_dsi_dcs_get_power_mode(dsi, &power_mode);
+	trace_am4001280_dcs(dsi, MIPI_DCS_GET_POWER_MODE, ret);
+	dsi->mode_flags = mode_flags;
+
+	if (ret < 0 || !(power_mode & MIPI_DCS_POWER_MODE_SLEEP) || !(power_mode & MIPI_DCS_POWER_MODE_DISPLAY)) {
+		DRM_DEV_INFO(dev, "No live panel to adopt (%d, power mode 0x%02x)\n", ret, ret < 0 ? 0 : power_mode);
+		regulator_bulk_disable(drv_data->num_supplies, drv_data->supplies);
+		goto reset;
+	}
+
+	drv_data->prepared = true;
+	trace_am4001280_state(dev, "prepared", true);
+	drv_data->enabled = true;
+	trace_am4001280_state(dev, "enabled", true);
+	drv_data->suspended = false;
+	drv_data->mcs_retained = true;
+	drv_data->handed_off = true;
+
+	/** The reference an enable would take, dropped on disable */
+	pm_runtime_get_noresume(dev);
+
+	DRM_DEV_INFO(dev, "Adopted live panel from bootloader (power mode 0x%02x)\n", power_mode);
+
+	return true;
+
+reset:
+	gpiod_set_value_cansleep(drv_data->reset_pin, 1);
+
+	return false;
+}
+
+/**
+ * Send a precompiled command set to the panel.
+ *
+ * Delay records sleep like any other step of the sequencing, in the sleep
+ * budget and the trace.
+ */
+static int push_mcs_seq(struct panel_driver_data *drv_data, const struct mcs_seq *seq)
+{
+	struct mipi_dsi_device *dsi = drv_data->dsi;
+	const u8 *rec = seq->buf;
+	int ret;
+
+	while (rec < seq->buf + seq->len) {
+		if (!rec[0]) {
+			am4001280atzqw00h_delay(drv_data, rec[1]);
+			rec += 2;
+			continue;
+		}
+
+		ret = mipi_dsi_generic_write(dsi, rec + 1, rec[0]);
+		trace_am4001280_mcs_write(dsi, rec + 1, rec[0], ret);
+		if (ret < 0)
+			return ret;
+
+		rec += rec[0] + 1;
+	}
+
+	return 0;
+}
+
+/**
+ * Read back the signature register of the MCS and compare it to the value sent.
+ *
+ * The read is always done in low power mode.
+ */
+static bool am4001280atzqw00h_signature_matches(struct panel_driver_data *drv_data)
+{
+	struct mipi_dsi_device *dsi = drv_data->dsi;
+	unsigned long mode_flags = dsi->mode_flags;
+	u8 reg = drv_data->mcs_signature.cmd;
+	u8 val;
+	int ret;
+
+	dsi->mode_flags |= MIPI_DSI_MODE_LPM;
+	ret = mipi_dsi_generic_read(dsi, &reg, 1, &val, 1);
+	dsi->mode_flags = mode_flags;
+	trace_am4001280_dcs(dsi, reg, ret);
+	if (ret < 0) {
+		DRM_DEV_DEBUG_DRIVER(&dsi->dev, "Failed to read MCS signature (%d)\n", ret);
+		return false;
+	}
+
+	return val == drv_data->mcs_signature.param;
+}
+
+/**
+ * Check whether the panel still holds the MCS by reading back its signature register.
+ */
+static bool am4001280atzqw00h_mcs_intact(struct panel_driver_data *drv_data)
+{
+	bool intact;
+
+	mutex_lock(&drv_data->mcs_lock);
+	intact = drv_data->mcs_retained && am4001280atzqw00h_signature_matches(drv_data);
+	mutex_unlock(&drv_data->mcs_lock);
+
+	return intact;
+}
+
+/**
+ * Send the MCS, measuring the transfer.
+ *
+ * In high-speed mode the signature register is read back afterwards. If the
+ * panel did not take the writes, high-speed mode is dropped for good and the
+ * MCS is sent again in low power mode.
+ */
+static int am4001280atzqw00h_send_mcs(struct panel_driver_data *drv_data)
+{
+	struct mipi_dsi_device *dsi = drv_data->dsi;
+	struct device *dev = &dsi->dev;
+	bool hs = drv_data->mcs_hs;
+	ktime_t start;
+	int ret;
+
+	/** Keep a firmware sequence from being swapped in while sending */
+	mutex_lock(&drv_data->mcs_lock);
+
+	if (hs)
+		dsi->mode_flags &= ~MIPI_DSI_MODE_LPM;
+
+	start = ktime_get();
+	ret = push_mcs_seq(drv_data, &drv_data->mcs);
+	drv_data->mcs_time_us = ktime_us_delta(ktime_get(), start);
+
+	dsi->mode_flags |= MIPI_DSI_MODE_LPM;
+
+	if (hs && (ret < 0 || !am4001280atzqw00h_signature_matches(drv_data))) {
+		dev_warn(dev, "Panel did not take the MCS in high-speed mode (%d), falling back to low power mode\n", ret);
+		drv_data->mcs_hs = false;
+
+		start = ktime_get();
+		ret = push_mcs_seq(drv_data, &drv_data->mcs);
+		drv_data->mcs_time_us = ktime_us_delta(ktime_get(), start);
+	}
+
+	if (!ret)
+		DRM_DEV_DEBUG_DRIVER(dev, "Sent MCS in %u %s packets within %lld us\n", drv_data->mcs.packets,
+				     drv_data->mcs_hs ? "HS" : "LP", drv_data->mcs_time_us);
+
+	mutex_unlock(&drv_data->mcs_lock);
+
+	return ret;
+}
+
+/**
+ * Replace the built-in MCS by a firmware sequence.
+ *
+ * The new sequence is compiled up front and swapped in under "mcs_lock", so it is
+ * sent from the next full initialisation on. Without a valid firmware the
+ * built-in sequence stays in use.
+ */
+static void am4001280atzqw00h_firmware_loaded(const struct firmware *fw, void *context)
+{
+	struct panel_driver_data *drv_data = context;
+	struct device *dev = &drv_data->dsi->dev;
+	struct cmd_set_entry *cmd_set;
+	struct cmd_set_entry signature;
+	struct mcs_report report;
+	struct mcs_report old_report;
+	struct mcs_seq seq;
+	u8 *old;
+	size_t count;
 	int ret;
 
-	if(!drv_data->suspended) {
-		DRM_DEV_ERROR(dev, "Got call to resume despite not being suspended (%d)\n", 1);
-		return 1;
+	if (!fw) {
+		DRM_DEV_INFO(dev, "No MCS firmware %s, using the built-in sequence\n", drv_data->fw_name);
+		goto done;
 	}
 
-	ret = mipi_dsi_dcs_exit_sleep_mode(dsi);
+	ret = mcs_parse_firmware(dev, fw, &cmd_set, &count);
 	if (ret < 0) {
-		DRM_DEV_ERROR(dev, "Failed to exit sleep mode (%d)\n", ret);
-		return ret;
+		DRM_DEV_ERROR(dev, "Failed to parse MCS firmware %s (%d)\n", drv_data->fw_name, ret);
+		goto release;
 	}
 
-	return 0;
+	ret = mcs_build(dev, &seq, &signature, drv_data->mcs_optimise ? &report : NULL, cmd_set, count, drv_data->mcs_mode);
+	kfree(cmd_set);
+	if (ret < 0) {
+		DRM_DEV_ERROR(dev, "Failed to compile MCS firmware %s (%d)\n", drv_data->fw_name, ret);
+		goto release;
+	}
+
+	mutex_lock(&drv_data->mcs_lock);
+	old = drv_data->mcs.buf;
+	drv_data->mcs = seq;
+	drv_data->mcs_signature = signature;
+	old_report = drv_data->mcs_report;
+	if (drv_data->mcs_optimise)
+		drv_data->mcs_report = report;
+	/** Whatever the panel holds now is the built-in sequence */
+	drv_data->mcs_retained = false;
+	mutex_unlock(&drv_data->mcs_lock);
+
+	devm_kfree(dev, old);
+	if (drv_data->mcs_optimise)
+		devm_kfree(dev, old_report.dropped);
+
+	DRM_DEV_INFO(dev, "Loaded MCS firmware %s with %zu entries in %u packets\n", drv_data->fw_name, count, seq.packets);
+	am4001280atzqw00h_dump_sequence(drv_data);
+
+release:
+	release_firmware(fw);
+done:
+	complete(&drv_data->fw_done);
 }
 
 /**
- * 
+ * Program the GRAM window the next memory write of the host goes to.
  */
-static int am4001280atzqw00h_enable(struct drm_panel *panel)
+static int am4001280atzqw00h_set_window(struct panel_driver_data *drv_data, u16 x, u16 y, u16 width, u16 height)
 {
-	struct panel_driver_data *drv_data = panel_to_drv_data(panel);
+	struct mipi_dsi_device *dsi = drv_data->dsi;
+	int ret;
+
+	ret = mipi_dsi_dcs_set_column_address(dsi, x, x + width - 1);
+	trace_am4001280_dcs(dsi, MIPI_DCS_SET_COLUMN_ADDRESS, ret);
+	if (ret < 0)
+		return ret;
+
+	ret = mipi_dsi_dcs_set_page_address(dsi, y, y + height - 1);
+	trace_am4001280_dcs(dsi, MIPI_DCS_SET_PAGE_ADDRESS, ret);
+
+	return ret;
+}
+
+/**
+ * Wake a panel that retained its registers, skipping reset and MCS.
+ */
+static int am4001280atzqw00h_fast_enable(struct panel_driver_data *drv_data)
+{
+	struct mipi_dsi_device *dsi = drv_data->dsi;
+	struct device *dev = &dsi->dev;
+	int ret;
+
+	ret = am4001280atzqw00h_resume(dev);
+	if (ret < 0) {
+		DRM_DEV_ERROR(dev, "Failed to exit sleep mode while fast enabling (%d)\n", ret);
+		return ret;
+	}
+
+	am4001280atzqw00h_delay(drv_data, drv_data->panel_data->delay.enable);
+
+	ret = mipi_dsi_dcs_set_display_on(dsi);
+	trace_am4001280_dcs(dsi, MIPI_DCS_SET_DISPLAY_ON, ret);
+	if (ret < 0) {
+		DRM_DEV_ERROR(dev, "Failed to set display to on while fast enabling (%d)\n", ret);
+		return ret;
+	}
+
+	/** The retained GRAM window may still be the last damaged rectangle */
+	if (drv_data->command_mode) {
+		ret = am4001280atzqw00h_set_window(drv_data, 0, 0, drv_data->panel_data->res.x, drv_data->panel_data->res.y);
+		if (ret < 0) {
+			DRM_DEV_ERROR(dev, "Failed to set the full update window while fast enabling (%d)\n", ret);
+			return ret;
+		}
+	}
 
-	return drv_data->pl_data->enable(drv_data);
+	return 0;
 }
 
 /**
@@ -543,11 +2334,27 @@ static int am4001280atzqw00h_platform_enable(struct panel_driver_data *drv_data)
 
 	DRM_DEV_DEBUG_DRIVER(dev, "Interface color format set to 0x%x\n", color_format);
 
+	drv_data->sleep_budget_ms = 0;
+
+	/** Skip the full initialisation if supply and reset were held since the last one */
+	if (am4001280atzqw00h_mcs_intact(drv_data)) {
+		ret = am4001280atzqw00h_fast_enable(drv_data);
+		if (!ret) {
+			DRM_DEV_DEBUG_DRIVER(dev, "Panel retained its MCS, enabled with %u ms of delays\n", drv_data->sleep_budget_ms);
+			goto done;
+		}
+	}
+	drv_data->mcs_retained = false;
+
 	ret = mipi_dsi_dcs_soft_reset(dsi);
+	trace_am4001280_dcs(dsi, MIPI_DCS_SOFT_RESET, ret);
 	if (ret < 0) {
 		DRM_DEV_ERROR(dev, "Failed to perform software reset (%d)\n", ret);
 		goto fail;
 	}
+
+	/** Always send sleep-in after the reset, regardless of the tracked state */
+	drv_data->suspended = false;
 	
 	/** Raise low power mode flag */
 	dsi->mode_flags |= MIPI_DSI_MODE_LPM;
@@ -559,215 +2366,560 @@ static int am4001280atzqw00h_platform_enable(struct panel_driver_data *drv_data)
 	}
 
 	ret = mipi_dsi_dcs_set_display_off(dsi);
+	trace_am4001280_dcs(dsi, MIPI_DCS_SET_DISPLAY_OFF, ret);
 	if (ret < 0) {
 		DRM_DEV_ERROR(dev, "Failed to set display off while enabling (%d)\n", ret);
 		goto fail;
 	}
 
-	ret = push_cmd_list(dsi, &mcs_am40001280[0], ARRAY_SIZE(mcs_am40001280));
+	ret = am4001280atzqw00h_send_mcs(drv_data);
 	if (ret < 0) {
 		DRM_DEV_ERROR(dev, "Failed to send MCS while enabling (%d)\n", ret);
 		goto fail;
 	}
 
-	ret = am4001280atzqw00h_resume(dev);
-	if (ret < 0) {
-		DRM_DEV_ERROR(dev, "Failed to exit sleep mode while enabling(%d)\n", ret);
-		goto fail;
-	}
+	ret = mipi_dsi_dcs_set_pixel_format(dsi, color_format);
+	trace_am4001280_dcs(dsi, MIPI_DCS_SET_PIXEL_FORMAT, ret);
+	if (ret < 0) {
+		DRM_DEV_ERROR(dev, "Failed to set pixel format while enabling (%d)\n", ret);
+		goto fail;
+	}
+
+	if (drv_data->address_mode) {
+		ret = mipi_dsi_dcs_set_address_mode(dsi, drv_data->address_mode);
+		trace_am4001280_dcs(dsi, MIPI_DCS_SET_ADDRESS_MODE, ret);
+		if (ret < 0) {
+			DRM_DEV_ERROR(dev, "Failed to set scan direction while enabling (%d)\n", ret);
+			goto fail;
+		}
+	}
+
+	ret = am4001280atzqw00h_resume(dev);
+	if (ret < 0) {
+		DRM_DEV_ERROR(dev, "Failed to exit sleep mode while enabling(%d)\n", ret);
+		goto fail;
+	}
+
+	am4001280atzqw00h_delay(drv_data, drv_data->panel_data->delay.enable);
+
+	ret = mipi_dsi_dcs_set_display_on(dsi);
+	trace_am4001280_dcs(dsi, MIPI_DCS_SET_DISPLAY_ON, ret);
+	if (ret < 0) {
+		DRM_DEV_ERROR(dev, "Failed to set display to on while enabling (%d)\n", ret);
+		goto fail;
+	}
+
+	if (drv_data->command_mode) {
+		ret = am4001280atzqw00h_set_window(drv_data, 0, 0, drv_data->panel_data->res.x, drv_data->panel_data->res.y);
+		if (ret < 0) {
+			DRM_DEV_ERROR(dev, "Failed to set the full update window while enabling (%d)\n", ret);
+			goto fail;
+		}
+	}
+
+	if (drv_data->te_gpio) {
+		ret = mipi_dsi_dcs_set_tear_on(dsi, MIPI_DSI_DCS_TEAR_MODE_VBLANK);
+		trace_am4001280_dcs(dsi, MIPI_DCS_SET_TEAR_ON, ret);
+		if (ret < 0) {
+			DRM_DEV_ERROR(dev, "Failed to enable tearing effect output while enabling (%d)\n", ret);
+			goto fail;
+		}
+	}
+
+	drv_data->mcs_retained = true;
+
+	DRM_DEV_DEBUG_DRIVER(dev, "Enabled with %u MCS packets and %u ms of delays\n", drv_data->mcs.packets, drv_data->sleep_budget_ms);
+
+done:
+	drv_data->enabled = true;
+	trace_am4001280_state(dev, "enabled", true);
+
+	return 0;
+
+fail:
+	drv_data->mcs_retained = false;
+	gpiod_set_value_cansleep(drv_data->reset_pin, 1);
+
+	return ret;
+
+}
+
+
+/**
+ * 
+ */
+static int __am4001280atzqw00h_disable(struct drm_panel *panel)
+{
+	struct panel_driver_data *drv_data = panel_to_drv_data(panel);
+	struct mipi_dsi_device *dsi = drv_data->dsi;
+	struct device *dev = &dsi->dev;
+	int ret;
+
+	am4001280atzqw00h_wait_ready(drv_data);
+
+	if(!drv_data->enabled) {
+		DRM_DEV_ERROR(dev, "Got call to disable despite not being enabled (%d)\n", 1);
+		return 1;
+	}
+
+	am4001280atzqw00h_idle_stop(drv_data);
+
+	ret = backlight_disable(drv_data->bl_dev);
+
+	if (ret < 0) {
+		DRM_DEV_ERROR(dev, "Failed to disable backlight (%d)\n", ret);
+		return ret;
+	}
+
+	am4001280atzqw00h_delay(drv_data, drv_data->panel_data->delay.disable);
+
+	/** Switch to HP mode to send the command more quicky */
+	dsi->mode_flags &= ~MIPI_DSI_MODE_LPM;
+
+	ret = mipi_dsi_dcs_set_display_off(dsi);
+	trace_am4001280_dcs(dsi, MIPI_DCS_SET_DISPLAY_OFF, ret);
+
+	if (ret < 0) {
+		DRM_DEV_ERROR(dev, "Failed to set display to OFF while disabling (%d)\n", ret);
+		return ret;
+	}
+
+	ret = am4001280atzqw00h_suspend(dev);
+	if (ret < 0) {
+		DRM_DEV_ERROR(dev, "Failed to enter sleep mode while disabling (%d)\n", ret);
+		goto fail;
+	}
+
+	/** Switch back to LP mode*/
+	dsi->mode_flags |= MIPI_DSI_MODE_LPM;
+
+	drv_data->enabled = false;
+	trace_am4001280_state(dev, "enabled", false);
+
+	/** An adopted panel turned off needs the full sequence from now on */
+	drv_data->handed_off = false;
+
+	/** Drop the reference taken on enable */
+	am4001280atzqw00h_pm_put(dev);
+
+	return 0;
+
+	fail:
+		dsi->mode_flags |= MIPI_DSI_MODE_LPM;
+		return ret;
+}
+
+/**
+ * Add every refresh rate of the mode table, the first one as preferred mode.
+ */
+static int am4001280atzqw00h_get_modes(struct drm_panel *panel)
+{
+	struct panel_driver_data *drv_data = panel_to_drv_data(panel);
+	const struct drm_panel_data *pd = drv_data->panel_data;
+	struct drm_connector *connector = panel->connector;
+	struct mipi_dsi_device *dsi = drv_data->dsi;
+	struct drm_display_mode *mode;
+	unsigned int count = 0;
+	unsigned int i;
+
+	for (i = 0; i < pd->num_modes; i++) {
+		if (!am4001280atzqw00h_mode_fits(drv_data, &pd->modes[i])) {
+			DRM_DEV_DEBUG_DRIVER(panel->dev, "Skipping mode %ux%u@%u exceeding the link rate\n",
+					     pd->modes[i].hdisplay, pd->modes[i].vdisplay, drm_mode_vrefresh(&pd->modes[i]));
+			continue;
+		}
+
+		mode = drm_mode_duplicate(panel->drm, &pd->modes[i]);
+
+		if (!mode) {
+			DRM_DEV_ERROR(panel->dev, "Failed to add mode %ux%u@%u\n", pd->modes[i].hdisplay, pd->modes[i].vdisplay, drm_mode_vrefresh(&pd->modes[i]));
+			return -ENOMEM;
+		}
+
+		drm_mode_set_name(mode);
+		mode->type = DRM_MODE_TYPE_DRIVER;
+		if (count++ == 0)
+			mode->type |= DRM_MODE_TYPE_PREFERRED;
+		drm_mode_probed_add(connector, mode);
+	}
+
+	connector->display_info.width_mm = pd->modes[0].width_mm;
+	connector->display_info.height_mm = pd->modes[0].height_mm;
+	connector->display_info.bus_flags = pd->bus_flags;
+
+	/** The DSI format is fixed at attach, so only the selected bus format can be driven */
+	drm_display_info_set_bus_formats(&connector->display_info, &drv_data->bus_format, 1);
+
+	return count;
+}
+
+/**
+ * Get the mounting rotation the panel does not compensate itself.
+ *
+ * The panel API offers no hook at connector init and get_modes() runs once
+ * the connector is registered, too late to attach a property. The driver
+ * owning the connector reports it instead, by setting
+ * display_info.panel_orientation and calling
+ * drm_connector_init_panel_orientation_property() before registering it.
+ */
+enum drm_panel_orientation am4001280atzqw00h_get_orientation(struct drm_panel *panel)
+{
+	struct panel_driver_data *drv_data = panel_to_drv_data(panel);
+
+	return drv_data->orientation;
+}
+EXPORT_SYMBOL_GPL(am4001280atzqw00h_get_orientation);
+
+/**
+ * Restrict the next frame transfer to a damaged rectangle.
+ *
+ * Only available in command mode, where the host then sends just the pixels
+ * of the rectangle. The rectangle is clipped to the panel.
+ */
+int am4001280atzqw00h_set_update_region(struct drm_panel *panel, const struct drm_rect *damage)
+{
+	struct panel_driver_data *drv_data = panel_to_drv_data(panel);
+	struct drm_rect clip = {
+		.x1 = 0,
+		.y1 = 0,
+		.x2 = drv_data->panel_data->res.x,
+		.y2 = drv_data->panel_data->res.y,
+	};
+	int ret;
+
+	if (!drv_data->command_mode)
+		return -EOPNOTSUPP;
+
+	if (!drm_rect_intersect(&clip, damage))
+		return -EINVAL;
+
+	ret = am4001280atzqw00h_pm_get(panel->dev);
+	if (ret < 0)
+		return ret;
+
+	if (drv_data->enabled) {
+		am4001280atzqw00h_activity(drv_data);
+		ret = am4001280atzqw00h_set_window(drv_data, clip.x1, clip.y1, drm_rect_width(&clip), drm_rect_height(&clip));
+	} else {
+		ret = -EBUSY;
+	}
+
+	am4001280atzqw00h_pm_put(panel->dev);
+
+	return ret;
+}
+EXPORT_SYMBOL_GPL(am4001280atzqw00h_set_update_region);
+
+/**
+ * == Backlight related functions ==
+ */
+
+/**
+ * Work item writing the latest recorded brightness to the panel.
+ */
+static void am4001280atzqw00h_backlight_flush_work(struct work_struct *work)
+{
+	struct panel_driver_data *drv_data = container_of(to_delayed_work(work), struct panel_driver_data, bl_work);
+	struct mipi_dsi_device *dsi = drv_data->dsi;
+	struct device *dev = &dsi->dev;
+	int brightness;
+	int ret;
+
+	/** Not worth waking a disabled panel runtime PM powered down, enable writes it again */
+	if (drv_data->idle_off)
+		return;
+
+	/** Not ordered behind "prepare_work" on its own queue */
+	am4001280atzqw00h_wait_ready(drv_data);
+
+	if (am4001280atzqw00h_pm_get(dev) < 0)
+		return;
+
+	/** Write at the start of vblank if the panel signals it */
+	am4001280atzqw00h_te_sync(drv_data);
+
+	brightness = READ_ONCE(drv_data->bl_pending);
+	drv_data->bl_last_flush = ktime_get();
+
+	if(!drv_data->prepared) {
+		dev_warn(dev, "Tried to update backlight status despite not being prepared.");
+		goto out;
+	}
+
+	ret = am4001280atzqw00h_write_brightness(drv_data, brightness);
+	trace_am4001280_backlight(dev, brightness, ret);
+	if (ret < 0)
+		dev_err(dev, "Failed to set backlight brightness while updating the backlight.(%d)\n", ret);
+	else
+		WRITE_ONCE(drv_data->bl_actual, brightness);
+
+out:
+	am4001280atzqw00h_pm_put(dev);
+}
+
+/**
+ * Record a brightness update and schedule it for the next frame slot.
+ *
+ * Updates arriving while a write is pending replace its value, so at most one
+ * brightness write per frame period goes out on the DSI link.
+ */
+static int __am4001280atzqw00h_backlight_update_status(struct backlight_device *bl_dev) 
+{
+	struct mipi_dsi_device *dsi = bl_get_data(bl_dev);
+	struct panel_driver_data *drv_data = mipi_dsi_get_drvdata(dsi);
+	s64 frame_us = USEC_PER_SEC / drv_data->panel_data->refresh;
+	s64 wait_us;
+
+	/** A manual brightness write ends a running fade at the written level */
+	if (current_work() != &drv_data->fade_work.work) {
+		mutex_lock(&drv_data->lock);
+		drv_data->fade_to = bl_dev->props.brightness;
+		drv_data->fade_duration_us = 0;
+		mutex_unlock(&drv_data->lock);
+		cancel_delayed_work(&drv_data->fade_work);
+	}
+
+	WRITE_ONCE(drv_data->bl_pending, bl_dev->props.brightness);
+
+	wait_us = ktime_us_delta(ktime_add_us(drv_data->bl_last_flush, frame_us), ktime_get());
+	queue_delayed_work(drv_data->bl_wq, &drv_data->bl_work, wait_us > 0 ? usecs_to_jiffies(wait_us) : 0);
+
+	return 0;
+}
+
+/**
+ * Report the brightness last written to the panel.
+ *
+ * Reading it back would cost a bus turnaround in LP mode on every sysfs read,
+ * the debugfs "verify_brightness" file does that on demand instead.
+ */
+static int __am4001280atzqw00h_get_backlight_brightness(struct backlight_device *bl_dev) 
+{
+	struct mipi_dsi_device *dsi = bl_get_data(bl_dev);
+	struct panel_driver_data *drv_data = mipi_dsi_get_drvdata(dsi);
+
+	return READ_ONCE(drv_data->bl_actual);
+}
+
+/**
+ * == Brightness fades ==
+ */
+
+/**
+ * Work item stepping a running fade, once per frame period.
+ */
+static void am4001280atzqw00h_fade_work(struct work_struct *work)
+{
+	struct panel_driver_data *drv_data = container_of(to_delayed_work(work), struct panel_driver_data, fade_work);
+	struct backlight_device *bl_dev = drv_data->bl_dev;
+	s64 frame_us = USEC_PER_SEC / drv_data->panel_data->refresh;
+	s64 elapsed_us;
+	bool done;
+	int level;
+
+	mutex_lock(&drv_data->lock);
+
+	elapsed_us = ktime_us_delta(ktime_get(), drv_data->fade_start);
+	done = elapsed_us >= drv_data->fade_duration_us;
+	if (done)
+		level = drv_data->fade_to;
+	else
+		level = drv_data->fade_from + div_s64((s64)(drv_data->fade_to - drv_data->fade_from) * elapsed_us,
+						      drv_data->fade_duration_us);
+
+	mutex_unlock(&drv_data->lock);
+
+	/** Takes the update lock, serialised against sysfs brightness writes */
+	if (level != bl_dev->props.brightness)
+		backlight_device_set_brightness(bl_dev, level);
+
+	if (!done)
+		queue_delayed_work(drv_data->wq, &drv_data->fade_work, usecs_to_jiffies(frame_us));
+}
+
+/**
+ * Show the running fade as "<current> <target> <remaining ms>".
+ */
+static ssize_t fade_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	struct panel_driver_data *drv_data = dev_get_drvdata(dev);
+	s64 remaining_us;
+	int target;
 
-	usleep_range(5000, 7000);
+	mutex_lock(&drv_data->lock);
+	target = drv_data->fade_to;
+	remaining_us = drv_data->fade_duration_us - ktime_us_delta(ktime_get(), drv_data->fade_start);
+	mutex_unlock(&drv_data->lock);
 
-	ret = mipi_dsi_dcs_set_display_on(dsi);
-	if (ret < 0) {
-		DRM_DEV_ERROR(dev, "Failed to set display to on while enabling (%d)\n", ret);
-		goto fail;
-	}
+	return sprintf(buf, "%d %d %lld\n", drv_data->bl_dev->props.brightness, target,
+		       remaining_us > 0 ? div_s64(remaining_us, USEC_PER_MSEC) : 0);
+}
 
-	backlight_enable(drv_data->bl_dev);
+/**
+ * Start a fade from the current brightness, written as "<target> <duration ms>".
+ *
+ * A new fade replaces a running one.
+ */
+static ssize_t fade_store(struct device *dev, struct device_attribute *attr, const char *buf, size_t count)
+{
+	struct panel_driver_data *drv_data = dev_get_drvdata(dev);
+	struct backlight_device *bl_dev = drv_data->bl_dev;
+	unsigned int target, duration_ms;
 
-	drv_data->enabled = true;
+	if (sscanf(buf, "%u %u", &target, &duration_ms) != 2)
+		return -EINVAL;
 
-	return 0;
+	if (target > bl_dev->props.max_brightness)
+		return -EINVAL;
 
-fail:
-	gpiod_set_value_cansleep(drv_data->reset_pin, 1);
+	mutex_lock(&drv_data->lock);
+	drv_data->fade_from = bl_dev->props.brightness;
+	drv_data->fade_to = target;
+	drv_data->fade_start = ktime_get();
+	drv_data->fade_duration_us = (s64)duration_ms * USEC_PER_MSEC;
+	mutex_unlock(&drv_data->lock);
 
-	return ret;
+	mod_delayed_work(drv_data->wq, &drv_data->fade_work, 0);
 
+	return count;
 }
+static DEVICE_ATTR_RW(fade);
 
+static struct attribute *am4001280atzqw00h_attrs[] = {
+	&dev_attr_fade.attr,
+	NULL
+};
+
+static const struct attribute_group am4001280atzqw00h_attr_group = {
+	.attrs = am4001280atzqw00h_attrs,
+};
 
 /**
- * 
+ * == Timed callbacks ==
+ *
+ * Every panel callback holds a runtime PM reference, waking the panel if it
+ * was powered down for being idle. The backlight callbacks never block on it.
  */
-static int am4001280atzqw00h_disable(struct drm_panel *panel)
+
+/**
+ * Timed wrapper of __am4001280atzqw00h_prepare().
+ */
+static int am4001280atzqw00h_prepare(struct drm_panel *panel)
 {
 	struct panel_driver_data *drv_data = panel_to_drv_data(panel);
-	struct mipi_dsi_device *dsi = drv_data->dsi;
-	struct device *dev = &dsi->dev;
+	ktime_t start = ktime_get();
 	int ret;
 
-	if(drv_data->enabled) {
-		DRM_DEV_ERROR(dev, "Got call to disable despite not being enabled (%d)\n", 1);
-		return 1;
-	}
-
-	ret = backlight_disable(drv_data->bl_dev);
-
-	if (ret < 0) {
-		DRM_DEV_ERROR(dev, "Failed to disable backlight (%d)\n", ret);
+	ret = am4001280atzqw00h_pm_get(panel->dev);
+	if (ret < 0)
 		return ret;
-	}
-
-	usleep_range(10000, 12000);
 
-	/** Switch to HP mode to send the command more quicky */
-	dsi->mode_flags &= ~MIPI_DSI_MODE_LPM;
+	ret = __am4001280atzqw00h_prepare(panel);
+	latency_stats_record(drv_data, LATENCY_PREPARE, start);
 
-	ret = mipi_dsi_dcs_set_display_off(dsi);
+	am4001280atzqw00h_pm_put(panel->dev);
 
-	if (ret < 0) {
-		DRM_DEV_ERROR(dev, "Failed to set display to OFF while disabling (%d)\n", ret);
-		return ret;
-	}
+	return ret;
+}
 
-	ret = am4001280atzqw00h_suspend(dev);
-	if (ret < 0) {
-		DRM_DEV_ERROR(dev, "Failed to enter sleep mode while disabling (%d)\n", ret);
-		goto fail;
-	}
+/**
+ * Timed wrapper of __am4001280atzqw00h_enable().
+ */
+static int am4001280atzqw00h_enable(struct drm_panel *panel)
+{
+	struct panel_driver_data *drv_data = panel_to_drv_data(panel);
+	ktime_t start = ktime_get();
+	int ret;
 
-	/** Switch back to LP mode*/
-	dsi->mode_flags |= MIPI_DSI_MODE_LPM;
+	ret = am4001280atzqw00h_pm_get(panel->dev);
+	if (ret < 0)
+		return ret;
 
-	drv_data->enabled = false;
+	ret = __am4001280atzqw00h_enable(panel);
+	latency_stats_record(drv_data, LATENCY_ENABLE, start);
 
-	return 0;
+	am4001280atzqw00h_pm_put(panel->dev);
 
-	fail:
-		dsi->mode_flags |= MIPI_DSI_MODE_LPM;
-		return ret;
+	return ret;
 }
 
 /**
- *
+ * Timed wrapper of __am4001280atzqw00h_disable().
  */
-static int am4001280atzqw00h_wait(struct drm_panel *panel, ktime_t start_ktime, unsigned int min_ms) 
+static int am4001280atzqw00h_disable(struct drm_panel *panel)
 {
 	struct panel_driver_data *drv_data = panel_to_drv_data(panel);
-	struct mipi_dsi_device *dsi = drv_data->dsi;
-	struct device *dev = &dsi->dev;
+	ktime_t start = ktime_get();
 	int ret;
-	ktime_t now_ktime, min_ktime;
-
-	if (!min_ms) {
-		DRM_DEV_ERROR(dev, "Got invalid waiting time (%d)\n", ret);
-		return 1;
-	}
 
-	min_ktime = ktime_add(start_ktime, ms_to_ktime(min_ms));
-	now_ktime = ktime_get();
-	ret = mipi_dsi_dcs_write(dsi, MIPI_DCS_ENTER_IDLE_MODE, NULL, 0);
-	if (ret < 0) {
-		DRM_DEV_ERROR(dev, "Failed to enter idle mode while waiting (%d)\n", ret);
+	ret = am4001280atzqw00h_pm_get(panel->dev);
+	if (ret < 0)
 		return ret;
-	}
 
-	if (ktime_before(now_ktime, min_ktime))
-		msleep(ktime_to_ms(ktime_sub(min_ktime, now_ktime)) + 1);
+	ret = __am4001280atzqw00h_disable(panel);
+	latency_stats_record(drv_data, LATENCY_DISABLE, start);
 
-	ret = mipi_dsi_dcs_write(dsi, MIPI_DCS_EXIT_IDLE_MODE, NULL, 0);
-	if (ret < 0) {
-		DRM_DEV_ERROR(dev, "Failed to exit idle mode while waiting (%d)\n", ret);
-		return ret;
-	}
-	return 0;
+	am4001280atzqw00h_pm_put(panel->dev);
+
+	return ret;
 }
 
 /**
+ * Timed wrapper of __am4001280atzqw00h_unprepare().
  *
+ * Unlike the other callbacks it does not resume the panel, one runtime PM
+ * already powered down only has its state cleared.
  */
-static int am4001280atzqw00h_get_modes(struct drm_panel *panel)
+static int am4001280atzqw00h_unprepare(struct drm_panel *panel)
 {
 	struct panel_driver_data *drv_data = panel_to_drv_data(panel);
-	struct drm_connector *connector = panel->connector;
-	struct mipi_dsi_device *dsi = drv_data->dsi;
-	struct drm_display_mode *mode;
-
-	mode = drm_mode_duplicate(panel->drm, &am4001280atzqw00h_mode);
-
-	if (!mode) {
-		DRM_DEV_ERROR(panel->dev, "Failed to add mode %ux%ux\n", am4001280atzqw00h_mode.hdisplay, am4001280atzqw00h_mode.vdisplay);
-		return -ENOMEM;
-	}
+	ktime_t start = ktime_get();
+	int ret;
 
-	drm_mode_set_name(mode);
-	mode->type = DRM_MODE_TYPE_DRIVER | DRM_MODE_TYPE_PREFERRED;
-	drm_mode_probed_add(connector, mode);
+	/** Hold off autosuspend and let one in flight settle "idle_off" */
+	pm_runtime_get_noresume(panel->dev);
+	pm_runtime_barrier(panel->dev);
 
-	connector->display_info.width_mm = mode->width_mm;
-	connector->display_info.height_mm = mode->height_mm;
-	connector->display_info.bus_flags = am4001280atzqw00h_data.bus_flags;
+	ret = __am4001280atzqw00h_unprepare(panel);
+	latency_stats_record(drv_data, LATENCY_UNPREPARE, start);
 
-	drm_display_info_set_bus_formats(&connector->display_info, am4001280atzqw00h_bus_formats, ARRAY_SIZE(am4001280atzqw00h_bus_formats));
+	am4001280atzqw00h_pm_put(panel->dev);
 
-	return 1;
+	return ret;
 }
 
 /**
- * == Backlight related functions ==
- */
-
-/**
- *
+ * Timed wrapper of __am4001280atzqw00h_backlight_update_status().
  */
-static int am4001280atzqw00h_backlight_update_status(struct backlight_device *bl_dev) 
+static int am4001280atzqw00h_backlight_update_status(struct backlight_device *bl_dev)
 {
 	struct mipi_dsi_device *dsi = bl_get_data(bl_dev);
-	struct device *dev = &dsi->dev;
 	struct panel_driver_data *drv_data = mipi_dsi_get_drvdata(dsi);
-	int ret = 0;
-
-	if(!drv_data->prepared) {
-		dev_warn(dev, "Tried to update backlight status despite not being prepared.");
-		return 0;
-	}
+	ktime_t start = ktime_get();
+	int ret;
 
-	ret = mipi_dsi_dcs_set_display_brightness(dsi, bl_dev->props.brightness);
-	if (ret < 0) {
-		dev_err(dev, "Failed to set backlight brightness while updating the backlight.(%d)\n", ret);
-		return ret;
-	}
+	/** Only queues the write, the flush work wakes the panel itself */
+	ret = __am4001280atzqw00h_backlight_update_status(bl_dev);
+	latency_stats_record(drv_data, LATENCY_BL_UPDATE, start);
 
-	return 0;
+	return ret;
 }
 
 /**
- *
+ * Timed wrapper of __am4001280atzqw00h_get_backlight_brightness().
  */
-static int am4001280atzqw00h_get_backlight_brightness(struct backlight_device *bl_dev) 
+static int am4001280atzqw00h_get_backlight_brightness(struct backlight_device *bl_dev)
 {
 	struct mipi_dsi_device *dsi = bl_get_data(bl_dev);
-	struct device *dev = &dsi->dev;
 	struct panel_driver_data *drv_data = mipi_dsi_get_drvdata(dsi);
-	u16 brightness;
+	ktime_t start = ktime_get();
 	int ret;
 
-	if(!drv_data->prepared) {
-		dev_warn(dev, "Tried to get backlight brightness despite not being prepared.");
-		return 0;
-	}
-
-	ret = mipi_dsi_dcs_get_display_brightness(dsi, &brightness);
-
-	if (ret < 0) {
-		dev_err(dev, "Failed to get backlight brightness.(%d)\n", ret);
-		return ret;
-	}
-	bl_dev->props.brightness = brightness;
+	/** Served from the cache, so no need to wake the panel */
+	ret = __am4001280atzqw00h_get_backlight_brightness(bl_dev);
+	latency_stats_record(drv_data, LATENCY_BL_GET, start);
 
-	return brightness & 0xff;
+	return ret;
 }
 
 /**
@@ -812,13 +2964,29 @@ static const struct of_device_id panel_of_match[] = {
 	{ /* sentinel */ }
 };
 
+#ifndef AM4001280_KUNIT
 MODULE_DEVICE_TABLE(of, panel_of_match);
+#endif
 
 
 /**
  * == MIPI fucntions ==
  */
 
+/**
+ * Stop all work and free the workqueue, run by devm once nothing can queue work anymore.
+ */
+static void am4001280atzqw00h_destroy_wq(void *data)
+{
+	struct panel_driver_data *drv_data = data;
+
+	cancel_delayed_work_sync(&drv_data->idle_work);
+	cancel_delayed_work_sync(&drv_data->fade_work);
+	cancel_delayed_work_sync(&drv_data->bl_work);
+	destroy_workqueue(drv_data->bl_wq);
+	destroy_workqueue(drv_data->wq);
+}
+
 /**
  * 
  */
@@ -830,6 +2998,9 @@ static int am4001280atzqw00h_probe(struct mipi_dsi_device *dsi)
 	const struct of_device_id *of_id = of_match_device(panel_of_match, dev);
 	struct backlight_properties bl_props;
 	u32 video_mode;
+	u32 mcs_mode;
+	u32 autosuspend_delay;
+	u32 bus_format;
 
 	int ret;
 	int i;
@@ -846,15 +3017,53 @@ static int am4001280atzqw00h_probe(struct mipi_dsi_device *dsi)
 	
 	mipi_dsi_set_drvdata(dsi, drv_data);
 
-	dsi->format = MIPI_DSI_FMT_RGB888;
+	dsi->format = am4001280atzqw00h_bus_formats[0].format;
+	drv_data->bus_format = am4001280atzqw00h_bus_formats[0].bus_format;
 	dsi->mode_flags =  MIPI_DSI_MODE_VIDEO_HSE | MIPI_DSI_MODE_VIDEO;
 
+	/** A narrower bus format cuts the link rate, RGB565 by a third */
+	ret = of_property_read_u32(dev_node, "bus-format", &bus_format);
+	if (!ret) {
+		for (i = 0; i < ARRAY_SIZE(am4001280atzqw00h_bus_formats); i++) {
+			if (am4001280atzqw00h_bus_formats[i].bus_format == bus_format)
+				break;
+		}
+
+		if (i < ARRAY_SIZE(am4001280atzqw00h_bus_formats)) {
+			dsi->format = am4001280atzqw00h_bus_formats[i].format;
+			drv_data->bus_format = bus_format;
+		} else {
+			DRM_DEV_ERROR(dev, "Got invalid bus format during probe 0x%x\n", bus_format);
+		}
+	}
+
+	/** Let the panel refresh from its GRAM, only damaged regions get transmitted */
+	drv_data->command_mode = of_property_read_bool(dev_node, "command-mode");
+	if (drv_data->command_mode)
+		dsi->mode_flags = 0;
+
+	/**
+	 * Enter idle mode after this many ms without damage, 0 never does.
+	 * Damage is only reported in command mode, video would keep changing unnoticed.
+	 */
+	of_property_read_u32(dev_node, "idle-timeout-ms", &drv_data->idle_timeout_ms);
+	if (drv_data->idle_timeout_ms && !drv_data->command_mode) {
+		DRM_DEV_ERROR(dev, "Got idle-timeout-ms without command-mode during probe, idle mode disabled\n");
+		drv_data->idle_timeout_ms = 0;
+	}
+
 	drv_data->dsi = dsi;
 	drv_data->pl_data = of_id->data;
+	drv_data->panel_data = &am4001280atzqw00h_data;
+	drv_data->hw_guard_wait = drv_data->panel_data->delay.unprepare;
+
+	ret = am4001280atzqw00h_parse_rotation(drv_data, dev_node);
+	if (ret < 0)
+		return ret;
 
 /** Try to set the correct video mode. */
 	ret = of_property_read_u32(dev_node, "video-mode", &video_mode);
-	if (!ret) {
+	if (!ret && !drv_data->command_mode) {
 		switch (video_mode) {
 		case 0:
 			/** Burst mode */
@@ -872,27 +3081,118 @@ static int am4001280atzqw00h_probe(struct mipi_dsi_device *dsi)
 			DRM_DEV_ERROR(dev, "Got invalid video mode during probe %d\n", video_mode);
 			break;
 		}
+	} else if (!drv_data->command_mode) {
+		/** Decided once the lane count is known */
+		drv_data->video_mode_auto = true;
 	}
 	ret = of_property_read_u32(dev_node, "dsi-lanes", &dsi->lanes);
 	if (ret < 0) {
 		DRM_DEV_ERROR(dev, "Failed to get the number of dsi-lanes during probe(%d)\n", ret);
 		return ret;
 	}
+	if (dsi->lanes < 1 || dsi->lanes > 4) {
+		DRM_DEV_ERROR(dev, "Got invalid number of dsi-lanes during probe %u\n", dsi->lanes);
+		return -EINVAL;
+	}
+
+	drv_data->max_hs_rate = drv_data->panel_data->max_hs_rate;
+	drv_data->max_lp_rate = drv_data->panel_data->max_lp_rate;
+	of_property_read_u32(dev_node, "max-hs-rate-mbps", &drv_data->max_hs_rate);
+	of_property_read_u32(dev_node, "max-lp-rate-mbps", &drv_data->max_lp_rate);
+	if (!drv_data->max_hs_rate || !drv_data->max_lp_rate) {
+		DRM_DEV_ERROR(dev, "Got zero max-hs-rate-mbps or max-lp-rate-mbps during probe (%d)\n", -EINVAL);
+		return -EINVAL;
+	}
+
+	ret = am4001280atzqw00h_check_link(drv_data);
+	if (ret < 0)
+		return ret;
+
+	if (drv_data->video_mode_auto)
+		am4001280atzqw00h_select_video_mode(drv_data);
+
+	/** Select how the MCS is sent, defaulting to one packet per register. */
+	drv_data->mcs_mode = MCS_MODE_SINGLE;
+	ret = of_property_read_u32(dev_node, "mcs-mode", &mcs_mode);
+	if (!ret) {
+		switch (mcs_mode) {
+		case MCS_MODE_SINGLE:
+		case MCS_MODE_BURST:
+			drv_data->mcs_mode = mcs_mode;
+			break;
+		default:
+			DRM_DEV_ERROR(dev, "Got invalid MCS mode during probe %d\n", mcs_mode);
+			break;
+		}
+	}
+
+	/** Drop writes the vendor table repeats without effect */
+	drv_data->mcs_optimise = of_property_read_bool(dev_node, "mcs-optimize");
+
+	ret = mcs_build(dev, &drv_data->mcs, &drv_data->mcs_signature, drv_data->mcs_optimise ? &drv_data->mcs_report : NULL,
+			&mcs_am40001280[0], ARRAY_SIZE(mcs_am40001280), drv_data->mcs_mode);
+	if (ret < 0) {
+		DRM_DEV_ERROR(dev, "Failed to compile MCS during probe (%d)\n", ret);
+		return ret;
+	}
+	DRM_DEV_DEBUG_DRIVER(dev, "Compiled %zu MCS entries into %u packets, %zu dropped\n", ARRAY_SIZE(mcs_am40001280),
+			     drv_data->mcs.packets, drv_data->mcs_report.num_dropped);
+
+	/** The panel tolerates HS commands, the MCS is verified after sending it that way */
+	drv_data->mcs_hs = of_property_read_bool(dev_node, "mcs-hs-mode");
+
+	/** Leave a panel brought up by the bootloader untouched until it is known to be live */
+	drv_data->seamless_handoff = of_property_read_bool(dev_node, "seamless-handoff");
 
 	drv_data->reset_pin = devm_gpiod_get_optional(dev, "reset",
-					       			GPIOD_OUT_LOW |
+					       			(drv_data->seamless_handoff ? GPIOD_ASIS : GPIOD_OUT_LOW) |
 					       			GPIOD_FLAGS_BIT_NONEXCLUSIVE);
 	if(IS_ERR(drv_data->reset_pin)) {
 		ret = PTR_ERR(drv_data->reset_pin);
 		DRM_DEV_ERROR(dev, "Failed get reset pin during probe (%d)\n", ret);
 		return ret;
 	}
-	gpiod_set_value_cansleep(drv_data->reset_pin, 1);
+	if (!drv_data->seamless_handoff)
+		gpiod_set_value_cansleep(drv_data->reset_pin, 1);
+
+	am4001280atzqw00h_dump_sequence(drv_data);
+
+	/** Optionally run the power-up sequencing off the atomic commit path */
+	drv_data->async_prepare = of_property_read_bool(dev_node, "async-prepare");
+
+	drv_data->wq = alloc_ordered_workqueue("%s", WQ_HIGHPRI, dev_name(dev));
+	if (!drv_data->wq) {
+		return -ENOMEM;
+	}
+	drv_data->bl_wq = alloc_ordered_workqueue("%s-bl", WQ_HIGHPRI, dev_name(dev));
+	if (!drv_data->bl_wq) {
+		destroy_workqueue(drv_data->wq);
+		return -ENOMEM;
+	}
+	INIT_WORK(&drv_data->prepare_work, am4001280atzqw00h_prepare_work);
+	INIT_DELAYED_WORK(&drv_data->bl_work, am4001280atzqw00h_backlight_flush_work);
+	INIT_DELAYED_WORK(&drv_data->fade_work, am4001280atzqw00h_fade_work);
+	INIT_DELAYED_WORK(&drv_data->idle_work, am4001280atzqw00h_idle_work);
+	mutex_init(&drv_data->lock);
+	mutex_init(&drv_data->mcs_lock);
+	init_completion(&drv_data->prepare_done);
+	complete_all(&drv_data->prepare_done);
+
+	/** Registered before the backlight and the sysfs group, so devm tears it down after them */
+	ret = devm_add_action_or_reset(dev, am4001280atzqw00h_destroy_wq, drv_data);
+	if (ret < 0)
+		return ret;
 
 	memset(&bl_props, 0, sizeof(bl_props));
 	bl_props.type = BACKLIGHT_RAW;
-	bl_props.brightness = 200;
-	bl_props.max_brightness = 255;
+	ret = am4001280atzqw00h_parse_brightness(drv_data, &bl_props);
+	if (ret < 0)
+		return ret;
+
+	ret = am4001280atzqw00h_te_init(drv_data);
+	if (ret < 0)
+		return ret;
+	drv_data->bl_actual = bl_props.brightness;
 	
 	drv_data->bl_dev = devm_backlight_device_register(dev, dev_name(dev), dev, dsi, &am4001280atzqw00h_backlight_ops, &bl_props);
 	if(IS_ERR(drv_data->bl_dev)) {
@@ -912,6 +3212,16 @@ static int am4001280atzqw00h_probe(struct mipi_dsi_device *dsi)
 	}
 	ret = devm_regulator_bulk_get(dev, drv_data->num_supplies, drv_data->supplies);
 
+
+	spin_lock_init(&drv_data->stats_lock);
+
+	/** Power the panel down when idle, only if an autosuspend delay is given */
+	ret = of_property_read_u32(dev_node, "autosuspend-delay-ms", &autosuspend_delay);
+	pm_runtime_set_autosuspend_delay(dev, ret ? -1 : autosuspend_delay);
+	pm_runtime_use_autosuspend(dev);
+	pm_runtime_set_active(dev);
+	pm_runtime_enable(dev);
+
 	drm_panel_init(&drv_data->panel);
 	drv_data->panel.funcs = &am4001280atzqw00h_funcs;
 	drv_data->panel.dev = dev;
@@ -920,17 +3230,43 @@ static int am4001280atzqw00h_probe(struct mipi_dsi_device *dsi)
 	ret = drm_panel_add(&drv_data->panel);
 	if (ret < 0) {
 		DRM_DEV_ERROR(dev, "Failed to add panel during probe (%d)\n", ret);
-		return ret;
+		goto fail_pm;
 	}
 
 	ret = mipi_dsi_attach(dsi);
 	if (ret < 0) {
 		DRM_DEV_ERROR(dev, "Failed to attach panel during probe (%d)\n", ret);
 		drm_panel_remove(&drv_data->panel);
-		return ret;
+		goto fail_pm;
+	}
+
+	if (drv_data->seamless_handoff)
+		am4001280atzqw00h_adopt(drv_data);
+
+	ret = devm_device_add_group(dev, &am4001280atzqw00h_attr_group);
+	if (ret < 0)
+		DRM_DEV_ERROR(dev, "Failed to add sysfs attributes during probe (%d)\n", ret);
+
+	am4001280atzqw00h_debugfs_init(drv_data);
+
+	/** Never block probe on the firmware, the built-in MCS serves until it arrives */
+	init_completion(&drv_data->fw_done);
+	if (!of_property_read_string(dev_node, "firmware-name", &drv_data->fw_name)) {
+		ret = request_firmware_nowait(THIS_MODULE, FW_ACTION_HOTPLUG, drv_data->fw_name, dev,
+					      GFP_KERNEL, drv_data, am4001280atzqw00h_firmware_loaded);
+		if (ret < 0) {
+			DRM_DEV_ERROR(dev, "Failed to request MCS firmware %s during probe (%d)\n", drv_data->fw_name, ret);
+			drv_data->fw_name = NULL;
+		}
 	}
 
 	return 0;
+
+fail_pm:
+	pm_runtime_dont_use_autosuspend(dev);
+	pm_runtime_disable(dev);
+
+	return ret;
 }
 
 
@@ -942,6 +3278,8 @@ static void am4001280atzqw00h_shutdown(struct mipi_dsi_device *dsi)
 	struct panel_driver_data *drv_data = mipi_dsi_get_drvdata(dsi);
 	int err;
 
+	/** Let a pending asynchronous prepare finish before powering down */
+	flush_workqueue(drv_data->wq);
 
 	err = am4001280atzqw00h_disable(&drv_data->panel);
 	if (err < 0) {
@@ -969,18 +3307,92 @@ static int am4001280atzqw00h_remove(struct mipi_dsi_device *dsi)
 	
 	drm_panel_remove(&drv_data->panel);
 
+	/** The firmware callback must not outlive the driver data */
+	if (drv_data->fw_name)
+		wait_for_completion(&drv_data->fw_done);
+
+	debugfs_remove_recursive(drv_data->debugfs);
+	cancel_delayed_work_sync(&drv_data->idle_work);
+
 	pm_runtime_dont_use_autosuspend(dev);
 	pm_runtime_disable(dev);
 
 	return 0;
 }
 
+/**
+ * Power a prepared but disabled panel down after the autosuspend delay.
+ *
+ * An enabled panel holds a runtime PM reference and never gets here. The
+ * prepared state seen by DRM is kept and restored in
+ * am4001280atzqw00h_runtime_resume().
+ */
+static int am4001280atzqw00h_runtime_suspend(struct device *dev)
+{
+	struct panel_driver_data *drv_data = dev_get_drvdata(dev);
+	int ret;
+
+	am4001280atzqw00h_wait_ready(drv_data);
+
+	if (!drv_data->prepared || drv_data->enabled || drv_data->idle_off)
+		return 0;
+
+	ret = am4001280atzqw00h_power_off(drv_data);
+	if (ret < 0)
+		return ret;
+
+	drv_data->handed_off = false;
+	drv_data->idle_off = true;
+	trace_am4001280_state(dev, "idle_off", true);
+
+	return 0;
+}
+
+/**
+ * Power the panel back on, DRM still considering it prepared.
+ */
+static int am4001280atzqw00h_runtime_resume(struct device *dev)
+{
+	struct panel_driver_data *drv_data = dev_get_drvdata(dev);
+	int ret;
+
+	if (!drv_data->idle_off)
+		return 0;
+
+	ret = am4001280atzqw00h_power_on(drv_data);
+	if (ret < 0)
+		return ret;
+
+	drv_data->idle_off = false;
+	trace_am4001280_state(dev, "idle_off", false);
+
+	return 0;
+}
+
+/**
+ * Settle the panel before system sleep.
+ *
+ * Runtime PM is left enabled, as pm_runtime_force_suspend() would make the
+ * disable and unprepare DRM issues for system sleep fail to take their
+ * references. Powering down is left to those callbacks, here only a running
+ * prepare and the pending brightness write are let finish.
+ */
+static int am4001280atzqw00h_system_suspend(struct device *dev)
+{
+	struct panel_driver_data *drv_data = dev_get_drvdata(dev);
+
+	am4001280atzqw00h_wait_ready(drv_data);
+	flush_delayed_work(&drv_data->bl_work);
+
+	return 0;
+}
+
 /**
  * Power management options
  */
 static const struct dev_pm_ops am4001280atzqw00h_pm_ops = {
-	SET_RUNTIME_PM_OPS(am4001280atzqw00h_suspend, am4001280atzqw00h_resume, NULL)
-	SET_SYSTEM_SLEEP_PM_OPS(am4001280atzqw00h_suspend, am4001280atzqw00h_resume)
+	SET_RUNTIME_PM_OPS(am4001280atzqw00h_runtime_suspend, am4001280atzqw00h_runtime_resume, NULL)
+	SET_SYSTEM_SLEEP_PM_OPS(am4001280atzqw00h_system_suspend, NULL)
 };
 
 /**
@@ -989,20 +3401,23 @@ static const struct dev_pm_ops am4001280atzqw00h_pm_ops = {
  * All local "_disc_" functions are exposed by binding them to this driver so 
  * the kernel can call them when desired.
  */
-static struct mipi_dsi_driver am4001280atzqw00h_driver = {
+static struct mipi_dsi_driver am4001280atzqw00h_driver __maybe_unused = {
 	.driver = {
 		.name="panel-ampire-am40001280",
 		.of_match_table = panel_of_match,
 		.owner = THIS_MODULE,
+		.pm = &am4001280atzqw00h_pm_ops,
 	},
 	.probe = am4001280atzqw00h_probe,
 	.shutdown = am4001280atzqw00h_shutdown,
 	.remove = am4001280atzqw00h_remove
 };
 
+#ifndef AM4001280_KUNIT
 /** Macro to (un-)register this driver instead of implementing "__init" or "__exit". */
 module_mipi_dsi_driver(am4001280atzqw00h_driver);
 
 MODULE_AUTHOR("Jan Greiner <jan.greiner@mnet-mail.de>");
 MODULE_DESCRIPTION("DRM driver for the Ampire AM-4001280ATZQW-00H MIPI DSI panel");
 MODULE_LICENSE("GPL v2");
+#endif
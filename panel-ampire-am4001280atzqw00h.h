@@ -0,0 +1,50 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+
+/**
+ * Ampire AM-4001280ATZQW-00H MIPI-DSI panel driver
+ *
+ * Interface for display controller drivers driving this panel.
+ *
+ * Author:
+ * Jan Greiner <jan.greiner@mnet-mail.de>
+ */
+
+#ifndef _PANEL_AMPIRE_AM4001280ATZQW00H_H
+#define _PANEL_AMPIRE_AM4001280ATZQW00H_H
+
+#include <linux/ktime.h>
+
+#include <drm/drm_connector.h>
+
+struct drm_panel;
+struct drm_rect;
+
+/**
+ * Get the timestamp of the last vblank signalled on the TE line.
+ *
+ * Returns the number of vblanks seen so far, or -ENODEV without a TE line.
+ */
+long am4001280atzqw00h_get_vblank_timestamp(struct drm_panel *panel, ktime_t *timestamp);
+
+/**
+ * Get the mounting rotation the panel does not compensate itself.
+ *
+ * To be reported through display_info.panel_orientation and
+ * drm_connector_init_panel_orientation_property() before the connector is
+ * registered.
+ */
+enum drm_panel_orientation am4001280atzqw00h_get_orientation(struct drm_panel *panel);
+
+/**
+ * Restrict the next frame transfer to a damaged rectangle.
+ *
+ * Only available in command mode. The rectangle is clipped to the panel.
+ */
+int am4001280atzqw00h_set_update_region(struct drm_panel *panel, const struct drm_rect *damage);
+
+/**
+ * Report damage from an atomic commit in command mode, taking the panel out of idle mode.
+ */
+void am4001280atzqw00h_notify_damage(struct drm_panel *panel);
+
+#endif /* _PANEL_AMPIRE_AM4001280ATZQW00H_H */
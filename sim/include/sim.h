@@ -0,0 +1,797 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+
+/**
+ * Kernel API stand-in of the userspace simulation harness
+ *
+ * Every kernel header the driver includes resolves to this file. It covers
+ * just what the driver uses, implemented by "kernel.c" on a plain Linux host:
+ * workqueues run when the harness lets time pass, sleeps only advance a
+ * virtual clock, and DSI transfers go to a model of the panel.
+ *
+ * Author:
+ * Jan Greiner <jan.greiner@mnet-mail.de>
+ */
+
+#ifndef _AM4001280_SIM_H
+#define _AM4001280_SIM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+
+/**
+ * == Types and helpers ==
+ */
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef unsigned long long u64;
+typedef int32_t s32;
+typedef long long s64;
+typedef uint16_t __le16;
+typedef s64 ktime_t;
+typedef unsigned int gfp_t;
+typedef unsigned short umode_t;
+
+#define __user
+#define __packed __attribute__((packed))
+#define __maybe_unused __attribute__((unused))
+#define __printf(a, b) __attribute__((format(printf, a, b)))
+
+#define GFP_KERNEL 0
+#define THIS_MODULE NULL
+
+#define EIO 5
+#define ENXIO 6
+#define EAGAIN 11
+#define ENOMEM 12
+#define EBUSY 16
+#define ENODEV 19
+#define EINVAL 22
+#define ENOSPC 28
+#define ERANGE 34
+#define EOVERFLOW 75
+#define EOPNOTSUPP 95
+#define ETIMEDOUT 110
+#define MAX_ERRNO 4095
+
+#define IS_ERR_VALUE(x) ((unsigned long)(x) >= (unsigned long)-MAX_ERRNO)
+#define IS_ERR(ptr) IS_ERR_VALUE(ptr)
+#define IS_ERR_OR_NULL(ptr) (!(ptr) || IS_ERR_VALUE(ptr))
+#define PTR_ERR(ptr) ((long)(ptr))
+#define ERR_PTR(err) ((void *)(long)(err))
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+#define container_of(ptr, type, member) ((type *)((char *)(ptr) - offsetof(type, member)))
+#define BIT(nr) (1UL << (nr))
+
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define min_t(type, a, b) min((type)(a), (type)(b))
+#define max_t(type, a, b) max((type)(a), (type)(b))
+#define clamp(val, lo, hi) min(max(val, lo), hi)
+#define clamp_t(type, val, lo, hi) min_t(type, max_t(type, val, lo), hi)
+#define DIV_ROUND_UP(n, d) (((n) + (d) - 1) / (d))
+#define DIV_ROUND_CLOSEST(n, d) (((n) + (d) / 2) / (d))
+
+#define U8_MAX 0xff
+#define U16_MAX 0xffff
+
+#define READ_ONCE(x) (x)
+#define WRITE_ONCE(x, val) ((x) = (val))
+
+#define le16_to_cpu(x) ((u16)(x))
+
+static inline int fls64(u64 x)
+{
+	return x ? 64 - __builtin_clzll(x) : 0;
+}
+
+static inline u64 div_u64(u64 dividend, u32 divisor)
+{
+	return dividend / divisor;
+}
+
+static inline s64 div_s64(s64 dividend, s32 divisor)
+{
+	return dividend / divisor;
+}
+
+static inline u64 div64_u64(u64 dividend, u64 divisor)
+{
+	return dividend / divisor;
+}
+
+int kstrtoint(const char *s, unsigned int base, int *res);
+int kstrtouint(const char *s, unsigned int base, unsigned int *res);
+int sysfs_emit(char *buf, const char *fmt, ...) __printf(2, 3);
+
+/**
+ * == Memory ==
+ */
+
+void *kmalloc(size_t size, gfp_t flags);
+void *kzalloc(size_t size, gfp_t flags);
+void *kcalloc(size_t n, size_t size, gfp_t flags);
+void *kmalloc_array(size_t n, size_t size, gfp_t flags);
+void kfree(const void *ptr);
+
+/**
+ * == Logging ==
+ */
+
+struct device;
+
+enum sim_log_level {
+	SIM_LOG_ERR,
+	SIM_LOG_WARN,
+	SIM_LOG_INFO,
+	SIM_LOG_DEBUG,
+};
+
+void sim_log(enum sim_log_level level, const struct device *dev, const char *fmt, ...) __printf(3, 4);
+void sim_hex_dump(const char *prefix, const void *buf, size_t len);
+
+#define DRM_DEV_ERROR(dev, ...) sim_log(SIM_LOG_ERR, dev, __VA_ARGS__)
+#define DRM_DEV_INFO(dev, ...) sim_log(SIM_LOG_INFO, dev, __VA_ARGS__)
+#define DRM_DEV_DEBUG(dev, ...) sim_log(SIM_LOG_DEBUG, dev, __VA_ARGS__)
+#define DRM_DEV_DEBUG_DRIVER(dev, ...) sim_log(SIM_LOG_DEBUG, dev, __VA_ARGS__)
+#define dev_err(dev, ...) sim_log(SIM_LOG_ERR, dev, __VA_ARGS__)
+#define dev_warn(dev, ...) sim_log(SIM_LOG_WARN, dev, __VA_ARGS__)
+#define dev_info(dev, ...) sim_log(SIM_LOG_INFO, dev, __VA_ARGS__)
+#define dev_dbg(dev, ...) sim_log(SIM_LOG_DEBUG, dev, __VA_ARGS__)
+
+#define DUMP_PREFIX_OFFSET 1
+#define print_hex_dump_debug(prefix, type, rowsize, groupsize, buf, len, ascii) sim_hex_dump(prefix, buf, len)
+
+/**
+ * == Modules ==
+ */
+
+struct module;
+
+#define MODULE_AUTHOR(x)
+#define MODULE_DESCRIPTION(x)
+#define MODULE_LICENSE(x)
+#define MODULE_DEVICE_TABLE(type, name)
+#define EXPORT_SYMBOL_GPL(sym)
+
+/**
+ * == Time ==
+ *
+ * The clock is the host's monotonic clock plus everything slept so far and the
+ * time the harness let pass, so sleeps cost no wall time but still pass for
+ * the driver.
+ */
+
+#define NSEC_PER_USEC 1000L
+#define NSEC_PER_MSEC 1000000L
+#define USEC_PER_MSEC 1000L
+#define USEC_PER_SEC 1000000L
+#define MSEC_PER_SEC 1000L
+#define HZ 1000
+
+ktime_t ktime_get(void);
+
+#define ktime_add_ms(kt, ms) ((kt) + (s64)(ms) * NSEC_PER_MSEC)
+#define ktime_add_us(kt, us) ((kt) + (s64)(us) * NSEC_PER_USEC)
+#define ktime_to_ns(kt) ((s64)(kt))
+#define ktime_us_delta(later, earlier) (((later) - (earlier)) / NSEC_PER_USEC)
+
+unsigned long msecs_to_jiffies(unsigned int ms);
+unsigned long usecs_to_jiffies(unsigned int us);
+
+void msleep(unsigned int ms);
+void usleep_range(unsigned long min, unsigned long max);
+
+/**
+ * == Locking ==
+ *
+ * The harness is single threaded, locks only have to exist.
+ */
+
+struct mutex {
+	int locked;
+};
+
+typedef struct {
+	int locked;
+} spinlock_t;
+
+#define mutex_init(lock) ((lock)->locked = 0)
+#define mutex_lock(lock) ((lock)->locked++)
+#define mutex_unlock(lock) ((lock)->locked--)
+#define spin_lock_init(lock) ((lock)->locked = 0)
+#define spin_lock(lock) ((lock)->locked++)
+#define spin_unlock(lock) ((lock)->locked--)
+#define spin_lock_irq(lock) spin_lock(lock)
+#define spin_unlock_irq(lock) spin_unlock(lock)
+#define spin_lock_irqsave(lock, flags) ((void)(flags = 0), spin_lock(lock))
+#define spin_unlock_irqrestore(lock, flags) ((void)(flags), spin_unlock(lock))
+#define lockdep_assert_held(lock) ((void)(lock))
+
+/**
+ * == Workqueues ==
+ *
+ * Queued work runs from sim_run_work(), which the harness calls whenever a
+ * worker thread would have had the chance to.
+ */
+
+struct work_struct;
+typedef void (*work_func_t)(struct work_struct *work);
+
+struct work_struct {
+	work_func_t func;
+	bool pending;
+	ktime_t due;
+	struct work_struct *next;
+};
+
+struct delayed_work {
+	struct work_struct work;
+};
+
+struct workqueue_struct;
+
+#define WQ_HIGHPRI 0x10
+
+#define INIT_WORK(w, f) ((w)->func = (f), (w)->pending = false)
+#define INIT_DELAYED_WORK(dw, f) INIT_WORK(&(dw)->work, f)
+#define to_delayed_work(w) container_of(w, struct delayed_work, work)
+
+struct workqueue_struct *alloc_ordered_workqueue(const char *fmt, unsigned int flags, ...);
+void destroy_workqueue(struct workqueue_struct *wq);
+void flush_workqueue(struct workqueue_struct *wq);
+bool queue_work(struct workqueue_struct *wq, struct work_struct *work);
+bool queue_delayed_work(struct workqueue_struct *wq, struct delayed_work *dwork, unsigned long delay);
+bool mod_delayed_work(struct workqueue_struct *wq, struct delayed_work *dwork, unsigned long delay);
+bool cancel_delayed_work(struct delayed_work *dwork);
+bool cancel_delayed_work_sync(struct delayed_work *dwork);
+bool flush_delayed_work(struct delayed_work *dwork);
+struct work_struct *current_work(void);
+
+/** Run the queued work that is due, earliest first, returning the number of items run */
+unsigned int sim_run_work(void);
+
+/** Let "us" pass, running the queued work as it falls due, returning the number of items run */
+unsigned int sim_idle_us(u64 us);
+
+/**
+ * == Completions and wait queues ==
+ *
+ * Waiting runs the queued work first, whatever the driver waits for can only
+ * come from there.
+ */
+
+struct completion {
+	unsigned int done;
+};
+
+typedef struct {
+	int unused;
+} wait_queue_head_t;
+
+#define init_completion(x) ((x)->done = 0)
+#define reinit_completion(x) ((x)->done = 0)
+#define complete(x) ((x)->done++)
+#define complete_all(x) ((x)->done = ~0u)
+void wait_for_completion(struct completion *x);
+
+#define init_waitqueue_head(wq) ((void)(wq))
+#define wake_up_all(wq) ((void)(wq))
+#define wait_event_timeout(wq, condition, timeout) \
+	((condition) ? (long)(timeout) : (sim_run_work(), (condition) ? (long)(timeout) : 0L))
+
+/**
+ * == Devices ==
+ */
+
+struct device_node;
+struct dev_pm_ops;
+struct sim_devres;
+
+struct device {
+	const char *init_name;
+	struct device_node *of_node;
+	void *driver_data;
+
+	/** Resources of the devm_*() calls, most recent first */
+	struct sim_devres *devres;
+
+	/** Runtime PM state, the callbacks taken from "pm" */
+	const struct dev_pm_ops *pm;
+	int pm_usage;
+	bool pm_enabled;
+	bool pm_active;
+	int pm_autosuspend_delay;
+	struct delayed_work pm_work;
+};
+
+struct attribute {
+	const char *name;
+	umode_t mode;
+};
+
+struct device_attribute {
+	struct attribute attr;
+	ssize_t (*show)(struct device *dev, struct device_attribute *attr, char *buf);
+	ssize_t (*store)(struct device *dev, struct device_attribute *attr, const char *buf, size_t count);
+};
+
+#define DEVICE_ATTR_RW(_name) \
+	struct device_attribute dev_attr_##_name = { { #_name, 0644 }, _name##_show, _name##_store }
+
+struct attribute_group {
+	struct attribute **attrs;
+};
+
+const char *dev_name(const struct device *dev);
+void *dev_get_drvdata(const struct device *dev);
+void dev_set_drvdata(struct device *dev, void *data);
+int devm_device_add_group(struct device *dev, const struct attribute_group *grp);
+
+void *devm_kmalloc(struct device *dev, size_t size, gfp_t flags);
+void *devm_kzalloc(struct device *dev, size_t size, gfp_t flags);
+void *devm_kcalloc(struct device *dev, size_t n, size_t size, gfp_t flags);
+void devm_kfree(struct device *dev, const void *ptr);
+int devm_add_action_or_reset(struct device *dev, void (*action)(void *), void *data);
+
+/** Release the devm resources of a device in reverse order, as the driver core does after remove */
+void sim_devres_release_all(struct device *dev);
+
+/**
+ * == Device tree ==
+ */
+
+#define SIM_PROP_MAX_VALUES 32
+
+struct sim_property {
+	const char *name;
+	const char *string;
+	u32 values[SIM_PROP_MAX_VALUES];
+	int count;
+};
+
+#define SIM_MAX_PROPERTIES 32
+
+struct device_node {
+	struct sim_property props[SIM_MAX_PROPERTIES];
+	int num_props;
+};
+
+struct of_device_id {
+	char compatible[128];
+	const void *data;
+};
+
+const struct of_device_id *of_match_device(const struct of_device_id *matches, const struct device *dev);
+bool of_property_read_bool(const struct device_node *np, const char *name);
+int of_property_read_u32(const struct device_node *np, const char *name, u32 *value);
+int of_property_read_u32_array(const struct device_node *np, const char *name, u32 *values, size_t count);
+int of_property_count_u32_elems(const struct device_node *np, const char *name);
+int of_property_read_string(const struct device_node *np, const char *name, const char **string);
+
+/**
+ * == Runtime PM ==
+ */
+
+struct dev_pm_ops {
+	int (*runtime_suspend)(struct device *dev);
+	int (*runtime_resume)(struct device *dev);
+	int (*suspend)(struct device *dev);
+	int (*resume)(struct device *dev);
+};
+
+#define SET_RUNTIME_PM_OPS(suspend_fn, resume_fn, idle_fn) \
+	.runtime_suspend = suspend_fn, .runtime_resume = resume_fn,
+#define SET_SYSTEM_SLEEP_PM_OPS(suspend_fn, resume_fn) \
+	.suspend = suspend_fn, .resume = resume_fn,
+
+int pm_runtime_get_sync(struct device *dev);
+void pm_runtime_get_noresume(struct device *dev);
+int pm_runtime_barrier(struct device *dev);
+int pm_runtime_put_autosuspend(struct device *dev);
+void pm_runtime_put_noidle(struct device *dev);
+void pm_runtime_mark_last_busy(struct device *dev);
+void pm_runtime_set_autosuspend_delay(struct device *dev, int delay);
+void pm_runtime_use_autosuspend(struct device *dev);
+void pm_runtime_dont_use_autosuspend(struct device *dev);
+int pm_runtime_set_active(struct device *dev);
+void pm_runtime_enable(struct device *dev);
+void pm_runtime_disable(struct device *dev);
+int pm_runtime_force_suspend(struct device *dev);
+int pm_runtime_force_resume(struct device *dev);
+
+/**
+ * == GPIOs, interrupts and regulators ==
+ */
+
+struct gpio_desc;
+
+enum gpiod_flags {
+	GPIOD_ASIS = 0,
+	GPIOD_IN = 1,
+	GPIOD_OUT_LOW = 3,
+	GPIOD_OUT_HIGH = 7,
+	GPIOD_FLAGS_BIT_NONEXCLUSIVE = 16,
+};
+
+struct gpio_desc *devm_gpiod_get_optional(struct device *dev, const char *con_id, enum gpiod_flags flags);
+void gpiod_set_value_cansleep(struct gpio_desc *desc, int value);
+int gpiod_to_irq(const struct gpio_desc *desc);
+
+typedef int irqreturn_t;
+
+#define IRQ_NONE 0
+#define IRQ_HANDLED 1
+#define IRQF_TRIGGER_RISING 0x1
+
+int devm_request_irq(struct device *dev, unsigned int irq, irqreturn_t (*handler)(int, void *), unsigned long flags,
+		     const char *name, void *dev_id);
+
+struct regulator;
+
+struct regulator_bulk_data {
+	const char *supply;
+	struct regulator *consumer;
+};
+
+int devm_regulator_bulk_get(struct device *dev, int num_consumers, struct regulator_bulk_data *consumers);
+int regulator_bulk_enable(int num_consumers, struct regulator_bulk_data *consumers);
+int regulator_bulk_disable(int num_consumers, struct regulator_bulk_data *consumers);
+
+/**
+ * == Firmware ==
+ */
+
+struct firmware {
+	size_t size;
+	const u8 *data;
+};
+
+#define FW_ACTION_HOTPLUG 1
+
+int request_firmware_nowait(struct module *module, bool uevent, const char *name, struct device *dev, gfp_t gfp,
+			    void *context, void (*cont)(const struct firmware *fw, void *context));
+void release_firmware(const struct firmware *fw);
+
+/**
+ * == debugfs ==
+ */
+
+struct dentry;
+
+struct seq_file {
+	FILE *stream;
+	void *private;
+};
+
+struct inode {
+	void *i_private;
+};
+
+struct file {
+	void *private_data;
+};
+
+struct file_operations {
+	struct module *owner;
+	int (*open)(struct inode *inode, struct file *file);
+	ssize_t (*read)(struct file *file, char __user *buf, size_t count, loff_t *ppos);
+	ssize_t (*write)(struct file *file, const char __user *buf, size_t count, loff_t *ppos);
+	loff_t (*llseek)(struct file *file, loff_t offset, int whence);
+	int (*release)(struct inode *inode, struct file *file);
+	int (*show)(struct seq_file *m, void *data);
+};
+
+/** The show function is kept in the fops, so the harness can print the file */
+#define DEFINE_SHOW_ATTRIBUTE(__name)						\
+static int __name##_open(struct inode *inode, struct file *file)		\
+{										\
+	file->private_data = inode->i_private;					\
+	return 0;								\
+}										\
+static const struct file_operations __name##_fops __maybe_unused = {		\
+	.owner = THIS_MODULE,							\
+	.open = __name##_open,							\
+	.show = __name##_show,							\
+}
+
+int seq_printf(struct seq_file *m, const char *fmt, ...) __printf(2, 3);
+int seq_puts(struct seq_file *m, const char *s);
+int simple_open(struct inode *inode, struct file *file);
+loff_t noop_llseek(struct file *file, loff_t offset, int whence);
+
+struct dentry *debugfs_create_dir(const char *name, struct dentry *parent);
+struct dentry *debugfs_create_file(const char *name, umode_t mode, struct dentry *parent, void *data,
+				   const struct file_operations *fops);
+void debugfs_remove_recursive(struct dentry *dentry);
+
+/**
+ * == Backlight ==
+ */
+
+#define FB_BLANK_UNBLANK 0
+#define FB_BLANK_POWERDOWN 4
+
+enum backlight_type {
+	BACKLIGHT_RAW = 1,
+};
+
+struct backlight_properties {
+	int brightness;
+	int max_brightness;
+	int power;
+	enum backlight_type type;
+};
+
+struct backlight_device;
+
+struct backlight_ops {
+	int (*update_status)(struct backlight_device *bl_dev);
+	int (*get_brightness)(struct backlight_device *bl_dev);
+};
+
+struct backlight_device {
+	struct backlight_properties props;
+	const struct backlight_ops *ops;
+	void *data;
+};
+
+struct backlight_device *devm_backlight_device_register(struct device *dev, const char *name, struct device *parent,
+							 void *devdata, const struct backlight_ops *ops,
+							 const struct backlight_properties *props);
+void *bl_get_data(struct backlight_device *bl_dev);
+int backlight_enable(struct backlight_device *bl_dev);
+int backlight_disable(struct backlight_device *bl_dev);
+int backlight_device_set_brightness(struct backlight_device *bl_dev, unsigned long brightness);
+
+/**
+ * == MIPI DCS and DSI ==
+ */
+
+enum {
+	MIPI_DCS_SOFT_RESET = 0x01,
+	MIPI_DCS_GET_POWER_MODE = 0x0a,
+	MIPI_DCS_ENTER_SLEEP_MODE = 0x10,
+	MIPI_DCS_EXIT_SLEEP_MODE = 0x11,
+	MIPI_DCS_SET_DISPLAY_OFF = 0x28,
+	MIPI_DCS_SET_DISPLAY_ON = 0x29,
+	MIPI_DCS_SET_COLUMN_ADDRESS = 0x2a,
+	MIPI_DCS_SET_PAGE_ADDRESS = 0x2b,
+	MIPI_DCS_WRITE_MEMORY_START = 0x2c,
+	MIPI_DCS_SET_TEAR_OFF = 0x34,
+	MIPI_DCS_SET_TEAR_ON = 0x35,
+	MIPI_DCS_SET_ADDRESS_MODE = 0x36,
+	MIPI_DCS_EXIT_IDLE_MODE = 0x38,
+	MIPI_DCS_ENTER_IDLE_MODE = 0x39,
+	MIPI_DCS_SET_PIXEL_FORMAT = 0x3a,
+	MIPI_DCS_SET_DISPLAY_BRIGHTNESS = 0x51,
+	MIPI_DCS_GET_DISPLAY_BRIGHTNESS = 0x52,
+};
+
+#define MIPI_DCS_POWER_MODE_IDLE BIT(6)
+#define MIPI_DCS_POWER_MODE_SLEEP BIT(4)
+#define MIPI_DCS_POWER_MODE_NORMAL BIT(3)
+#define MIPI_DCS_POWER_MODE_DISPLAY BIT(2)
+
+enum {
+	MIPI_DSI_GENERIC_SHORT_WRITE_0_PARAM = 0x03,
+	MIPI_DSI_GENERIC_READ_REQUEST_1_PARAM = 0x14,
+	MIPI_DSI_DCS_SHORT_WRITE = 0x05,
+	MIPI_DSI_DCS_SHORT_WRITE_PARAM = 0x15,
+	MIPI_DSI_GENERIC_SHORT_WRITE_1_PARAM = 0x13,
+	MIPI_DSI_GENERIC_SHORT_WRITE_2_PARAM = 0x23,
+	MIPI_DSI_DCS_READ = 0x06,
+	MIPI_DSI_GENERIC_LONG_WRITE = 0x29,
+	MIPI_DSI_DCS_LONG_WRITE = 0x39,
+};
+
+enum mipi_dsi_pixel_format {
+	MIPI_DSI_FMT_RGB888,
+	MIPI_DSI_FMT_RGB666,
+	MIPI_DSI_FMT_RGB666_PACKED,
+	MIPI_DSI_FMT_RGB565,
+};
+
+enum mipi_dsi_dcs_tear_mode {
+	MIPI_DSI_DCS_TEAR_MODE_VBLANK,
+	MIPI_DSI_DCS_TEAR_MODE_VHBLANK,
+};
+
+#define MIPI_DSI_MODE_VIDEO BIT(0)
+#define MIPI_DSI_MODE_VIDEO_BURST BIT(1)
+#define MIPI_DSI_MODE_VIDEO_SYNC_PULSE BIT(2)
+#define MIPI_DSI_MODE_VIDEO_HSE BIT(4)
+#define MIPI_DSI_MODE_LPM BIT(11)
+
+struct mipi_dsi_device {
+	struct device dev;
+	unsigned int channel;
+	unsigned int lanes;
+	enum mipi_dsi_pixel_format format;
+	unsigned long mode_flags;
+};
+
+struct mipi_dsi_driver {
+	struct {
+		const char *name;
+		const struct of_device_id *of_match_table;
+		struct module *owner;
+		const struct dev_pm_ops *pm;
+	} driver;
+	int (*probe)(struct mipi_dsi_device *dsi);
+	int (*remove)(struct mipi_dsi_device *dsi);
+	void (*shutdown)(struct mipi_dsi_device *dsi);
+};
+
+#define module_mipi_dsi_driver(driver)
+
+#define mipi_dsi_set_drvdata(dsi, data) dev_set_drvdata(&(dsi)->dev, data)
+#define mipi_dsi_get_drvdata(dsi) dev_get_drvdata(&(dsi)->dev)
+
+int mipi_dsi_attach(struct mipi_dsi_device *dsi);
+int mipi_dsi_detach(struct mipi_dsi_device *dsi);
+int mipi_dsi_pixel_format_to_bpp(enum mipi_dsi_pixel_format fmt);
+ssize_t mipi_dsi_generic_write(struct mipi_dsi_device *dsi, const void *payload, size_t size);
+ssize_t mipi_dsi_generic_read(struct mipi_dsi_device *dsi, const void *params, size_t num_params, void *data, size_t size);
+ssize_t mipi_dsi_dcs_write(struct mipi_dsi_device *dsi, u8 cmd, const void *data, size_t len);
+ssize_t mipi_dsi_dcs_read(struct mipi_dsi_device *dsi, u8 cmd, void *data, size_t len);
+int mipi_dsi_dcs_soft_reset(struct mipi_dsi_device *dsi);
+int mipi_dsi_dcs_enter_sleep_mode(struct mipi_dsi_device *dsi);
+int mipi_dsi_dcs_exit_sleep_mode(struct mipi_dsi_device *dsi);
+int mipi_dsi_dcs_set_display_off(struct mipi_dsi_device *dsi);
+int mipi_dsi_dcs_set_display_on(struct mipi_dsi_device *dsi);
+int mipi_dsi_dcs_set_column_address(struct mipi_dsi_device *dsi, u16 start, u16 end);
+int mipi_dsi_dcs_set_page_address(struct mipi_dsi_device *dsi, u16 start, u16 end);
+int mipi_dsi_dcs_set_tear_on(struct mipi_dsi_device *dsi, enum mipi_dsi_dcs_tear_mode mode);
+int mipi_dsi_dcs_set_pixel_format(struct mipi_dsi_device *dsi, u8 format);
+int mipi_dsi_dcs_set_address_mode(struct mipi_dsi_device *dsi, u8 mode);
+int mipi_dsi_dcs_get_power_mode(struct mipi_dsi_device *dsi, u8 *mode);
+int mipi_dsi_dcs_set_display_brightness(struct mipi_dsi_device *dsi, u16 brightness);
+int mipi_dsi_dcs_get_display_brightness(struct mipi_dsi_device *dsi, u16 *brightness);
+
+/**
+ * == Media bus formats ==
+ */
+
+#define MEDIA_BUS_FMT_RGB565_1X16 0x1017
+#define MEDIA_BUS_FMT_RGB666_1X18 0x1009
+#define MEDIA_BUS_FMT_RGB888_1X24 0x100a
+
+/**
+ * == DRM ==
+ */
+
+struct drm_device;
+struct i2c_adapter;
+struct edid;
+
+#define DRM_DISPLAY_MODE_LEN 32
+
+#define DRM_MODE_TYPE_PREFERRED BIT(3)
+#define DRM_MODE_TYPE_DRIVER BIT(6)
+#define DRM_MODE_FLAG_NHSYNC BIT(1)
+#define DRM_MODE_FLAG_NVSYNC BIT(3)
+#define DRM_MODE_CONNECTOR_DSI 16
+#define DRM_BUS_FLAG_DE_LOW BIT(0)
+#define DRM_BUS_FLAG_PIXDATA_DRIVE_NEGEDGE BIT(3)
+
+struct drm_display_mode {
+	int clock;
+	int hdisplay, hsync_start, hsync_end, htotal;
+	int vdisplay, vsync_start, vsync_end, vtotal;
+	unsigned int flags;
+	unsigned int type;
+	int width_mm, height_mm;
+	char name[DRM_DISPLAY_MODE_LEN];
+};
+
+struct display_timing;
+
+enum drm_panel_orientation {
+	DRM_MODE_PANEL_ORIENTATION_UNKNOWN = -1,
+	DRM_MODE_PANEL_ORIENTATION_NORMAL = 0,
+	DRM_MODE_PANEL_ORIENTATION_BOTTOM_UP,
+	DRM_MODE_PANEL_ORIENTATION_LEFT_UP,
+	DRM_MODE_PANEL_ORIENTATION_RIGHT_UP,
+};
+
+struct drm_display_info {
+	unsigned int width_mm, height_mm;
+	u32 bus_flags;
+	const u32 *bus_formats;
+	unsigned int num_bus_formats;
+};
+
+struct drm_connector {
+	struct drm_device *dev;
+	struct drm_display_info display_info;
+};
+
+struct drm_panel;
+
+struct drm_panel_funcs {
+	int (*prepare)(struct drm_panel *panel);
+	int (*enable)(struct drm_panel *panel);
+	int (*disable)(struct drm_panel *panel);
+	int (*unprepare)(struct drm_panel *panel);
+	int (*get_modes)(struct drm_panel *panel);
+};
+
+struct drm_panel {
+	struct drm_device *drm;
+	struct drm_connector *connector;
+	struct device *dev;
+	const struct drm_panel_funcs *funcs;
+};
+
+struct drm_rect {
+	int x1, y1, x2, y2;
+};
+
+static inline int drm_rect_width(const struct drm_rect *r)
+{
+	return r->x2 - r->x1;
+}
+
+static inline int drm_rect_height(const struct drm_rect *r)
+{
+	return r->y2 - r->y1;
+}
+
+bool drm_rect_intersect(struct drm_rect *r1, const struct drm_rect *r2);
+
+void drm_panel_init(struct drm_panel *panel);
+int drm_panel_add(struct drm_panel *panel);
+void drm_panel_remove(struct drm_panel *panel);
+struct drm_display_mode *drm_mode_duplicate(struct drm_device *dev, const struct drm_display_mode *mode);
+void drm_mode_set_name(struct drm_display_mode *mode);
+void drm_mode_probed_add(struct drm_connector *connector, struct drm_display_mode *mode);
+int drm_mode_vrefresh(const struct drm_display_mode *mode);
+int drm_display_info_set_bus_formats(struct drm_display_info *info, const u32 *formats, unsigned int num_formats);
+int drm_connector_init_panel_orientation_property(struct drm_connector *connector, int width, int height);
+
+/**
+ * == Tracepoints ==
+ *
+ * Events compile to nothing, the harness logs the DSI traffic itself.
+ */
+
+#define TP_PROTO(...) __VA_ARGS__
+#define TRACE_EVENT(name, proto, ...) static inline void trace_##name(proto) {}
+
+/**
+ * == Harness ==
+ */
+
+/** Counters of the fake kernel, cleared by the harness as it sees fit */
+struct sim_counters {
+	unsigned int packets;
+	size_t bytes;
+	u64 slept_us;
+	unsigned int resets;
+};
+
+extern struct sim_counters sim_counters;
+
+/** Print every DSI packet to this stream, if set */
+extern FILE *sim_dsi_log;
+
+/** Log driver messages up to this level */
+extern enum sim_log_level sim_log_level;
+
+/** Directory firmware files are loaded from, none if NULL */
+extern const char *sim_firmware_dir;
+
+/** Live allocations, nonzero after remove if the driver leaked any */
+extern long sim_allocations;
+
+/** Let time pass for the driver without counting it as slept */
+void sim_advance_us(u64 us);
+
+#endif /* _AM4001280_SIM_H */
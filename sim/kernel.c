@@ -0,0 +1,1273 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+/**
+ * Kernel API stand-in of the userspace simulation harness
+ *
+ * Implements the calls declared in "include/sim.h" on a plain Linux host.
+ * DSI transfers go to a model of the panel, which keeps the MCS registers and
+ * the DCS state as long as it is powered and out of reset.
+ *
+ * Author:
+ * Jan Greiner <jan.greiner@mnet-mail.de>
+ */
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <sim.h>
+
+struct sim_counters sim_counters;
+FILE *sim_dsi_log;
+enum sim_log_level sim_log_level = SIM_LOG_WARN;
+const char *sim_firmware_dir;
+long sim_allocations;
+
+/** Time passed without passing on the host, see ktime_get() */
+static s64 sim_time_offset_ns;
+
+/**
+ * == Helpers ==
+ */
+
+int kstrtoint(const char *s, unsigned int base, int *res)
+{
+	char *end;
+	long val;
+
+	errno = 0;
+	val = strtol(s, &end, base);
+	if (end == s || (*end && *end != '\n') || errno || val != (int)val)
+		return -EINVAL;
+
+	*res = val;
+
+	return 0;
+}
+
+int kstrtouint(const char *s, unsigned int base, unsigned int *res)
+{
+	int val;
+	int ret;
+
+	ret = kstrtoint(s, base, &val);
+	if (ret < 0 || val < 0)
+		return -EINVAL;
+
+	*res = val;
+
+	return 0;
+}
+
+int sysfs_emit(char *buf, const char *fmt, ...)
+{
+	va_list args;
+	int len;
+
+	va_start(args, fmt);
+	len = vsnprintf(buf, 4096, fmt, args);
+	va_end(args);
+
+	return len;
+}
+
+/**
+ * == Memory ==
+ */
+
+void *kmalloc(size_t size, gfp_t flags)
+{
+	void *ptr = malloc(size);
+
+	if (ptr)
+		sim_allocations++;
+
+	return ptr;
+}
+
+void *kzalloc(size_t size, gfp_t flags)
+{
+	void *ptr = kmalloc(size, flags);
+
+	if (ptr)
+		memset(ptr, 0, size);
+
+	return ptr;
+}
+
+void *kcalloc(size_t n, size_t size, gfp_t flags)
+{
+	return kmalloc_array(n, size, flags);
+}
+
+void *kmalloc_array(size_t n, size_t size, gfp_t flags)
+{
+	if (size && n > SIZE_MAX / size)
+		return NULL;
+
+	return kzalloc(n * size, flags);
+}
+
+void kfree(const void *ptr)
+{
+	if (!ptr)
+		return;
+
+	sim_allocations--;
+	free((void *)ptr);
+}
+
+/**
+ * == Logging ==
+ */
+
+void sim_log(enum sim_log_level level, const struct device *dev, const char *fmt, ...)
+{
+	static const char * const names[] = { "error", "warning", "info", "debug" };
+	va_list args;
+
+	if (level > sim_log_level)
+		return;
+
+	fprintf(stderr, "%s: %s: ", dev ? dev_name(dev) : "sim", names[level]);
+	va_start(args, fmt);
+	vfprintf(stderr, fmt, args);
+	va_end(args);
+}
+
+void sim_hex_dump(const char *prefix, const void *buf, size_t len)
+{
+	const u8 *bytes = buf;
+	size_t i;
+
+	if (sim_log_level < SIM_LOG_DEBUG)
+		return;
+
+	for (i = 0; i < len; i++) {
+		if (!(i % 16))
+			fprintf(stderr, "%s%s%08zx:", i ? "\n" : "", prefix, i);
+		fprintf(stderr, " %02x", bytes[i]);
+	}
+	fprintf(stderr, "\n");
+}
+
+/**
+ * == Time ==
+ */
+
+ktime_t ktime_get(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (s64)ts.tv_sec * 1000000000 + ts.tv_nsec + sim_time_offset_ns;
+}
+
+/**
+ * Let time pass without spending it, as a sleep or the harness idling.
+ */
+void sim_advance_us(u64 us)
+{
+	sim_time_offset_ns += us * NSEC_PER_USEC;
+}
+
+unsigned long msecs_to_jiffies(unsigned int ms)
+{
+	return ms;
+}
+
+unsigned long usecs_to_jiffies(unsigned int us)
+{
+	return DIV_ROUND_UP(us, USEC_PER_MSEC);
+}
+
+void msleep(unsigned int ms)
+{
+	sim_counters.slept_us += ms * USEC_PER_MSEC;
+	sim_advance_us(ms * USEC_PER_MSEC);
+}
+
+void usleep_range(unsigned long min, unsigned long max)
+{
+	sim_counters.slept_us += min;
+	sim_advance_us(min);
+}
+
+/**
+ * == Workqueues ==
+ */
+
+/** Queued work of all workqueues, in the order it was queued */
+static struct work_struct *sim_work_list;
+static struct work_struct *sim_current_work;
+
+/** Workqueues only need to be told apart from NULL */
+struct workqueue_struct {
+	int unused;
+};
+
+struct workqueue_struct *alloc_ordered_workqueue(const char *fmt, unsigned int flags, ...)
+{
+	return kzalloc(sizeof(struct workqueue_struct), GFP_KERNEL);
+}
+
+void destroy_workqueue(struct workqueue_struct *wq)
+{
+	flush_workqueue(wq);
+	kfree(wq);
+}
+
+void flush_workqueue(struct workqueue_struct *wq)
+{
+	sim_run_work();
+}
+
+static void sim_work_unlink(struct work_struct *work)
+{
+	struct work_struct **pos;
+
+	for (pos = &sim_work_list; *pos; pos = &(*pos)->next) {
+		if (*pos == work) {
+			*pos = work->next;
+			break;
+		}
+	}
+
+	work->pending = false;
+	work->next = NULL;
+}
+
+static bool sim_queue(struct work_struct *work, unsigned long delay)
+{
+	struct work_struct **pos;
+
+	if (work->pending)
+		return false;
+
+	work->due = ktime_get() + (s64)delay * NSEC_PER_MSEC;
+	work->pending = true;
+	work->next = NULL;
+
+	for (pos = &sim_work_list; *pos; pos = &(*pos)->next)
+		;
+	*pos = work;
+
+	return true;
+}
+
+bool queue_work(struct workqueue_struct *wq, struct work_struct *work)
+{
+	return sim_queue(work, 0);
+}
+
+bool queue_delayed_work(struct workqueue_struct *wq, struct delayed_work *dwork, unsigned long delay)
+{
+	return sim_queue(&dwork->work, delay);
+}
+
+bool mod_delayed_work(struct workqueue_struct *wq, struct delayed_work *dwork, unsigned long delay)
+{
+	bool pending = cancel_delayed_work(dwork);
+
+	sim_queue(&dwork->work, delay);
+
+	return pending;
+}
+
+bool cancel_delayed_work(struct delayed_work *dwork)
+{
+	bool pending = dwork->work.pending;
+
+	sim_work_unlink(&dwork->work);
+
+	return pending;
+}
+
+bool cancel_delayed_work_sync(struct delayed_work *dwork)
+{
+	return cancel_delayed_work(dwork);
+}
+
+bool flush_delayed_work(struct delayed_work *dwork)
+{
+	struct work_struct *prev = sim_current_work;
+
+	if (!dwork->work.pending)
+		return false;
+
+	/** The delay is cut short, the work runs right away */
+	sim_work_unlink(&dwork->work);
+	sim_current_work = &dwork->work;
+	dwork->work.func(&dwork->work);
+	sim_current_work = prev;
+
+	return true;
+}
+
+struct work_struct *current_work(void)
+{
+	return sim_current_work;
+}
+
+unsigned int sim_run_work(void)
+{
+	struct work_struct *work;
+	struct work_struct *pos;
+	struct work_struct *prev = sim_current_work;
+	unsigned int count = 0;
+	ktime_t now;
+
+	do {
+		now = ktime_get();
+		work = NULL;
+		for (pos = sim_work_list; pos; pos = pos->next) {
+			if (pos->due <= now && (!work || pos->due < work->due))
+				work = pos;
+		}
+		if (!work)
+			break;
+
+		sim_work_unlink(work);
+		sim_current_work = work;
+		work->func(work);
+		sim_current_work = prev;
+		count++;
+	} while (true);
+
+	return count;
+}
+
+unsigned int sim_idle_us(u64 us)
+{
+	ktime_t end = ktime_get() + (s64)us * NSEC_PER_USEC;
+	struct work_struct *pos;
+	unsigned int count = 0;
+	ktime_t next;
+	ktime_t now;
+
+	do {
+		count += sim_run_work();
+
+		/** Jump to the next work item falling due before the end */
+		next = end;
+		for (pos = sim_work_list; pos; pos = pos->next)
+			next = min(next, pos->due);
+
+		now = ktime_get();
+		if (next > now)
+			sim_time_offset_ns += next - now;
+	} while (next < end);
+
+	return count + sim_run_work();
+}
+
+/**
+ * == Completions ==
+ */
+
+void wait_for_completion(struct completion *x)
+{
+	if (!x->done)
+		sim_run_work();
+
+	if (!x->done) {
+		fprintf(stderr, "sim: fatal: waiting for a completion nothing will complete\n");
+		exit(EXIT_FAILURE);
+	}
+
+	if (x->done != ~0u)
+		x->done--;
+}
+
+/**
+ * == Devices ==
+ */
+
+struct sim_devres {
+	struct sim_devres *next;
+	void (*action)(void *data);
+	void *data;
+};
+
+const char *dev_name(const struct device *dev)
+{
+	return dev->init_name;
+}
+
+void *dev_get_drvdata(const struct device *dev)
+{
+	return dev->driver_data;
+}
+
+void dev_set_drvdata(struct device *dev, void *data)
+{
+	dev->driver_data = data;
+}
+
+int devm_device_add_group(struct device *dev, const struct attribute_group *grp)
+{
+	return 0;
+}
+
+static int sim_devres_add(struct device *dev, void (*action)(void *), void *data)
+{
+	struct sim_devres *res = kzalloc(sizeof(*res), GFP_KERNEL);
+
+	if (!res)
+		return -ENOMEM;
+
+	res->action = action;
+	res->data = data;
+	res->next = dev->devres;
+	dev->devres = res;
+
+	return 0;
+}
+
+void *devm_kmalloc(struct device *dev, size_t size, gfp_t flags)
+{
+	void *ptr = kmalloc(size, flags);
+
+	if (ptr && sim_devres_add(dev, NULL, ptr) < 0) {
+		kfree(ptr);
+		return NULL;
+	}
+
+	return ptr;
+}
+
+void *devm_kzalloc(struct device *dev, size_t size, gfp_t flags)
+{
+	void *ptr = devm_kmalloc(dev, size, flags);
+
+	if (ptr)
+		memset(ptr, 0, size);
+
+	return ptr;
+}
+
+void *devm_kcalloc(struct device *dev, size_t n, size_t size, gfp_t flags)
+{
+	if (size && n > SIZE_MAX / size)
+		return NULL;
+
+	return devm_kzalloc(dev, n * size, flags);
+}
+
+void devm_kfree(struct device *dev, const void *ptr)
+{
+	struct sim_devres **pos;
+	struct sim_devres *res;
+
+	for (pos = &dev->devres; *pos; pos = &(*pos)->next) {
+		res = *pos;
+		if (!res->action && res->data == ptr) {
+			*pos = res->next;
+			kfree(res->data);
+			kfree(res);
+			return;
+		}
+	}
+
+	fprintf(stderr, "%s: warning: devm_kfree() of memory not allocated by devm\n", dev_name(dev));
+}
+
+int devm_add_action_or_reset(struct device *dev, void (*action)(void *), void *data)
+{
+	int ret = sim_devres_add(dev, action, data);
+
+	if (ret < 0)
+		action(data);
+
+	return ret;
+}
+
+void sim_devres_release_all(struct device *dev)
+{
+	struct sim_devres *res;
+
+	while ((res = dev->devres)) {
+		dev->devres = res->next;
+		if (res->action)
+			res->action(res->data);
+		else
+			kfree(res->data);
+		kfree(res);
+	}
+}
+
+/**
+ * == Device tree ==
+ */
+
+static const struct sim_property *sim_find_property(const struct device_node *np, const char *name)
+{
+	int i;
+
+	for (i = 0; np && i < np->num_props; i++) {
+		if (!strcmp(np->props[i].name, name))
+			return &np->props[i];
+	}
+
+	return NULL;
+}
+
+const struct of_device_id *of_match_device(const struct of_device_id *matches, const struct device *dev)
+{
+	/** The harness only creates devices matching the driver */
+	return matches;
+}
+
+bool of_property_read_bool(const struct device_node *np, const char *name)
+{
+	return sim_find_property(np, name);
+}
+
+int of_property_read_u32(const struct device_node *np, const char *name, u32 *value)
+{
+	return of_property_read_u32_array(np, name, value, 1);
+}
+
+int of_property_read_u32_array(const struct device_node *np, const char *name, u32 *values, size_t count)
+{
+	const struct sim_property *prop = sim_find_property(np, name);
+
+	if (!prop)
+		return -EINVAL;
+	if (prop->count < (int)count)
+		return -EOVERFLOW;
+
+	memcpy(values, prop->values, count * sizeof(*values));
+
+	return 0;
+}
+
+int of_property_count_u32_elems(const struct device_node *np, const char *name)
+{
+	const struct sim_property *prop = sim_find_property(np, name);
+
+	return prop ? prop->count : -EINVAL;
+}
+
+int of_property_read_string(const struct device_node *np, const char *name, const char **string)
+{
+	const struct sim_property *prop = sim_find_property(np, name);
+
+	if (!prop || !prop->string)
+		return -EINVAL;
+
+	*string = prop->string;
+
+	return 0;
+}
+
+/**
+ * == Runtime PM ==
+ */
+
+static void sim_pm_work(struct work_struct *work)
+{
+	struct device *dev = container_of(to_delayed_work(work), struct device, pm_work);
+
+	if (dev->pm_usage || !dev->pm_active || !dev->pm_enabled)
+		return;
+
+	if (!dev->pm->runtime_suspend(dev))
+		dev->pm_active = false;
+}
+
+int pm_runtime_get_sync(struct device *dev)
+{
+	int ret;
+
+	dev->pm_usage++;
+	cancel_delayed_work(&dev->pm_work);
+
+	if (dev->pm_active || !dev->pm_enabled)
+		return 1;
+
+	ret = dev->pm->runtime_resume(dev);
+	if (ret < 0)
+		return ret;
+
+	dev->pm_active = true;
+
+	return 0;
+}
+
+void pm_runtime_get_noresume(struct device *dev)
+{
+	dev->pm_usage++;
+}
+
+int pm_runtime_barrier(struct device *dev)
+{
+	/** Suspends run from the work list and never are in flight here */
+	return 0;
+}
+
+int pm_runtime_put_autosuspend(struct device *dev)
+{
+	if (--dev->pm_usage || dev->pm_autosuspend_delay < 0)
+		return 0;
+
+	/** Restart the timer of a suspend already pending */
+	dev->pm_work.work.func = sim_pm_work;
+	mod_delayed_work(NULL, &dev->pm_work, msecs_to_jiffies(dev->pm_autosuspend_delay));
+
+	return 0;
+}
+
+void pm_runtime_put_noidle(struct device *dev)
+{
+	dev->pm_usage--;
+}
+
+void pm_runtime_mark_last_busy(struct device *dev)
+{
+}
+
+void pm_runtime_set_autosuspend_delay(struct device *dev, int delay)
+{
+	dev->pm_autosuspend_delay = delay;
+}
+
+void pm_runtime_use_autosuspend(struct device *dev)
+{
+}
+
+void pm_runtime_dont_use_autosuspend(struct device *dev)
+{
+}
+
+int pm_runtime_set_active(struct device *dev)
+{
+	dev->pm_active = true;
+
+	return 0;
+}
+
+void pm_runtime_enable(struct device *dev)
+{
+	dev->pm_enabled = true;
+}
+
+void pm_runtime_disable(struct device *dev)
+{
+	cancel_delayed_work(&dev->pm_work);
+	dev->pm_enabled = false;
+}
+
+int pm_runtime_force_suspend(struct device *dev)
+{
+	return dev->pm->runtime_suspend(dev);
+}
+
+int pm_runtime_force_resume(struct device *dev)
+{
+	return dev->pm->runtime_resume(dev);
+}
+
+/**
+ * == Panel model ==
+ */
+
+static struct {
+	/** Enabled supplies and the state of the reset line */
+	int supplies;
+	bool reset;
+
+	/** MCS registers, written by generic writes */
+	u8 page;
+	u8 regs[256][256];
+
+	/** DCS state */
+	bool sleep_out;
+	bool display_on;
+	bool idle;
+	u8 brightness[2];
+} sim_panel = { .reset = true };
+
+static bool sim_panel_alive(void)
+{
+	return sim_panel.supplies && !sim_panel.reset;
+}
+
+/**
+ * Return the panel to its power-on state, losing the MCS.
+ */
+static void sim_panel_reset(void)
+{
+	memset(sim_panel.regs, 0, sizeof(sim_panel.regs));
+	sim_panel.page = 0;
+	sim_panel.sleep_out = false;
+	sim_panel.display_on = false;
+	sim_panel.idle = false;
+	sim_counters.resets++;
+}
+
+static void sim_panel_generic_write(const u8 *tx, size_t len)
+{
+	size_t i;
+
+	if (!len)
+		return;
+
+	if (tx[0] == 0xB1 && len > 1)
+		sim_panel.page = tx[1];
+	else if (tx[0] != 0xB0)
+		for (i = 1; i < len; i++)
+			sim_panel.regs[sim_panel.page][(u8)(tx[0] + i - 1)] = tx[i];
+}
+
+static void sim_panel_dcs_write(const u8 *tx, size_t len)
+{
+	switch (tx[0]) {
+	case MIPI_DCS_SOFT_RESET:
+		sim_panel_reset();
+		break;
+	case MIPI_DCS_ENTER_SLEEP_MODE:
+	case MIPI_DCS_EXIT_SLEEP_MODE:
+		sim_panel.sleep_out = tx[0] == MIPI_DCS_EXIT_SLEEP_MODE;
+		break;
+	case MIPI_DCS_SET_DISPLAY_OFF:
+	case MIPI_DCS_SET_DISPLAY_ON:
+		sim_panel.display_on = tx[0] == MIPI_DCS_SET_DISPLAY_ON;
+		break;
+	case MIPI_DCS_ENTER_IDLE_MODE:
+	case MIPI_DCS_EXIT_IDLE_MODE:
+		sim_panel.idle = tx[0] == MIPI_DCS_ENTER_IDLE_MODE;
+		break;
+	case MIPI_DCS_SET_DISPLAY_BRIGHTNESS:
+		memset(sim_panel.brightness, 0, sizeof(sim_panel.brightness));
+		memcpy(sim_panel.brightness, tx + 1, min(len - 1, sizeof(sim_panel.brightness)));
+		break;
+	default:
+		break;
+	}
+}
+
+static ssize_t sim_panel_dcs_read(u8 cmd, u8 *rx, size_t len)
+{
+	memset(rx, 0, len);
+
+	switch (cmd) {
+	case MIPI_DCS_GET_POWER_MODE:
+		rx[0] = (sim_panel.idle ? MIPI_DCS_POWER_MODE_IDLE : 0) |
+			(sim_panel.sleep_out ? MIPI_DCS_POWER_MODE_SLEEP : 0) |
+			MIPI_DCS_POWER_MODE_NORMAL |
+			(sim_panel.display_on ? MIPI_DCS_POWER_MODE_DISPLAY : 0);
+		break;
+	case MIPI_DCS_GET_DISPLAY_BRIGHTNESS:
+		memcpy(rx, sim_panel.brightness, min(len, sizeof(sim_panel.brightness)));
+		break;
+	default:
+		break;
+	}
+
+	return len;
+}
+
+/**
+ * == MIPI DSI ==
+ */
+
+/**
+ * Log a packet and pass it to the panel model.
+ *
+ * Writes to a dead panel are lost silently like on the real link, reads time
+ * out instead.
+ */
+static ssize_t sim_dsi_transfer(struct mipi_dsi_device *dsi, u8 type, const void *tx, size_t tx_len, void *rx,
+				size_t rx_len)
+{
+	const u8 *bytes = tx;
+	size_t i;
+
+	sim_counters.packets++;
+	sim_counters.bytes += tx_len;
+
+	if (sim_dsi_log) {
+		fprintf(sim_dsi_log, "  %s %02x:", dsi->mode_flags & MIPI_DSI_MODE_LPM ? "LP" : "HS", type);
+		for (i = 0; i < tx_len; i++)
+			fprintf(sim_dsi_log, " %02x", bytes[i]);
+		fprintf(sim_dsi_log, "%s\n", sim_panel_alive() ? "" : " (panel off)");
+	}
+
+	if (!sim_panel_alive())
+		return rx_len ? -ETIMEDOUT : (ssize_t)tx_len;
+
+	switch (type) {
+	case MIPI_DSI_GENERIC_SHORT_WRITE_0_PARAM:
+	case MIPI_DSI_GENERIC_SHORT_WRITE_1_PARAM:
+	case MIPI_DSI_GENERIC_SHORT_WRITE_2_PARAM:
+	case MIPI_DSI_GENERIC_LONG_WRITE:
+		sim_panel_generic_write(bytes, tx_len);
+		break;
+	case MIPI_DSI_GENERIC_READ_REQUEST_1_PARAM:
+		memset(rx, 0, rx_len);
+		if (rx_len)
+			((u8 *)rx)[0] = sim_panel.regs[sim_panel.page][bytes[0]];
+		return rx_len;
+	case MIPI_DSI_DCS_READ:
+		return sim_panel_dcs_read(bytes[0], rx, rx_len);
+	default:
+		sim_panel_dcs_write(bytes, tx_len);
+		break;
+	}
+
+	return tx_len;
+}
+
+int mipi_dsi_attach(struct mipi_dsi_device *dsi)
+{
+	return 0;
+}
+
+int mipi_dsi_detach(struct mipi_dsi_device *dsi)
+{
+	return 0;
+}
+
+int mipi_dsi_pixel_format_to_bpp(enum mipi_dsi_pixel_format fmt)
+{
+	switch (fmt) {
+	case MIPI_DSI_FMT_RGB888:
+	case MIPI_DSI_FMT_RGB666:
+		return 24;
+	case MIPI_DSI_FMT_RGB666_PACKED:
+		return 18;
+	case MIPI_DSI_FMT_RGB565:
+		return 16;
+	}
+
+	return -EINVAL;
+}
+
+ssize_t mipi_dsi_generic_write(struct mipi_dsi_device *dsi, const void *payload, size_t size)
+{
+	static const u8 short_types[] = {
+		MIPI_DSI_GENERIC_SHORT_WRITE_0_PARAM,
+		MIPI_DSI_GENERIC_SHORT_WRITE_1_PARAM,
+		MIPI_DSI_GENERIC_SHORT_WRITE_2_PARAM,
+	};
+
+	return sim_dsi_transfer(dsi, size < 3 ? short_types[size] : MIPI_DSI_GENERIC_LONG_WRITE, payload, size, NULL, 0);
+}
+
+ssize_t mipi_dsi_generic_read(struct mipi_dsi_device *dsi, const void *params, size_t num_params, void *data, size_t size)
+{
+	if (num_params != 1)
+		return -EINVAL;
+
+	return sim_dsi_transfer(dsi, MIPI_DSI_GENERIC_READ_REQUEST_1_PARAM, params, num_params, data, size);
+}
+
+ssize_t mipi_dsi_dcs_write(struct mipi_dsi_device *dsi, u8 cmd, const void *data, size_t len)
+{
+	u8 buf[64];
+	u8 type;
+
+	if (len >= sizeof(buf))
+		return -EINVAL;
+
+	buf[0] = cmd;
+	if (len)
+		memcpy(buf + 1, data, len);
+
+	if (len == 0)
+		type = MIPI_DSI_DCS_SHORT_WRITE;
+	else if (len == 1)
+		type = MIPI_DSI_DCS_SHORT_WRITE_PARAM;
+	else
+		type = MIPI_DSI_DCS_LONG_WRITE;
+
+	return sim_dsi_transfer(dsi, type, buf, len + 1, NULL, 0);
+}
+
+ssize_t mipi_dsi_dcs_read(struct mipi_dsi_device *dsi, u8 cmd, void *data, size_t len)
+{
+	return sim_dsi_transfer(dsi, MIPI_DSI_DCS_READ, &cmd, 1, data, len);
+}
+
+static int sim_dcs_write_status(struct mipi_dsi_device *dsi, u8 cmd, const void *data, size_t len)
+{
+	ssize_t ret = mipi_dsi_dcs_write(dsi, cmd, data, len);
+
+	return ret < 0 ? ret : 0;
+}
+
+int mipi_dsi_dcs_soft_reset(struct mipi_dsi_device *dsi)
+{
+	return sim_dcs_write_status(dsi, MIPI_DCS_SOFT_RESET, NULL, 0);
+}
+
+int mipi_dsi_dcs_enter_sleep_mode(struct mipi_dsi_device *dsi)
+{
+	return sim_dcs_write_status(dsi, MIPI_DCS_ENTER_SLEEP_MODE, NULL, 0);
+}
+
+int mipi_dsi_dcs_exit_sleep_mode(struct mipi_dsi_device *dsi)
+{
+	return sim_dcs_write_status(dsi, MIPI_DCS_EXIT_SLEEP_MODE, NULL, 0);
+}
+
+int mipi_dsi_dcs_set_display_off(struct mipi_dsi_device *dsi)
+{
+	return sim_dcs_write_status(dsi, MIPI_DCS_SET_DISPLAY_OFF, NULL, 0);
+}
+
+int mipi_dsi_dcs_set_display_on(struct mipi_dsi_device *dsi)
+{
+	return sim_dcs_write_status(dsi, MIPI_DCS_SET_DISPLAY_ON, NULL, 0);
+}
+
+int mipi_dsi_dcs_set_column_address(struct mipi_dsi_device *dsi, u16 start, u16 end)
+{
+	u8 payload[4] = { start >> 8, start & 0xff, end >> 8, end & 0xff };
+
+	return sim_dcs_write_status(dsi, MIPI_DCS_SET_COLUMN_ADDRESS, payload, sizeof(payload));
+}
+
+int mipi_dsi_dcs_set_page_address(struct mipi_dsi_device *dsi, u16 start, u16 end)
+{
+	u8 payload[4] = { start >> 8, start & 0xff, end >> 8, end & 0xff };
+
+	return sim_dcs_write_status(dsi, MIPI_DCS_SET_PAGE_ADDRESS, payload, sizeof(payload));
+}
+
+int mipi_dsi_dcs_set_tear_on(struct mipi_dsi_device *dsi, enum mipi_dsi_dcs_tear_mode mode)
+{
+	u8 value = mode;
+
+	return sim_dcs_write_status(dsi, MIPI_DCS_SET_TEAR_ON, &value, sizeof(value));
+}
+
+int mipi_dsi_dcs_set_pixel_format(struct mipi_dsi_device *dsi, u8 format)
+{
+	return sim_dcs_write_status(dsi, MIPI_DCS_SET_PIXEL_FORMAT, &format, sizeof(format));
+}
+
+int mipi_dsi_dcs_set_address_mode(struct mipi_dsi_device *dsi, u8 mode)
+{
+	return sim_dcs_write_status(dsi, MIPI_DCS_SET_ADDRESS_MODE, &mode, sizeof(mode));
+}
+
+int mipi_dsi_dcs_get_power_mode(struct mipi_dsi_device *dsi, u8 *mode)
+{
+	ssize_t ret = mipi_dsi_dcs_read(dsi, MIPI_DCS_GET_POWER_MODE, mode, sizeof(*mode));
+
+	return ret < 0 ? ret : 0;
+}
+
+int mipi_dsi_dcs_set_display_brightness(struct mipi_dsi_device *dsi, u16 brightness)
+{
+	u8 payload[2] = { brightness & 0xff, brightness >> 8 };
+
+	return sim_dcs_write_status(dsi, MIPI_DCS_SET_DISPLAY_BRIGHTNESS, payload, sizeof(payload));
+}
+
+int mipi_dsi_dcs_get_display_brightness(struct mipi_dsi_device *dsi, u16 *brightness)
+{
+	u8 payload[2];
+	ssize_t ret = mipi_dsi_dcs_read(dsi, MIPI_DCS_GET_DISPLAY_BRIGHTNESS, payload, sizeof(payload));
+
+	if (ret < 0)
+		return ret;
+
+	*brightness = payload[0] | (payload[1] << 8);
+
+	return 0;
+}
+
+/**
+ * == GPIOs, interrupts and regulators ==
+ */
+
+/** Only the reset line is wired up, the panel model follows it */
+struct gpio_desc {
+	int unused;
+};
+
+static struct gpio_desc sim_reset_gpio;
+
+struct gpio_desc *devm_gpiod_get_optional(struct device *dev, const char *con_id, enum gpiod_flags flags)
+{
+	if (strcmp(con_id, "reset"))
+		return NULL;
+
+	if ((flags & GPIOD_OUT_HIGH) == GPIOD_OUT_HIGH)
+		gpiod_set_value_cansleep(&sim_reset_gpio, 1);
+	else if ((flags & GPIOD_OUT_LOW) == GPIOD_OUT_LOW)
+		gpiod_set_value_cansleep(&sim_reset_gpio, 0);
+
+	return &sim_reset_gpio;
+}
+
+void gpiod_set_value_cansleep(struct gpio_desc *desc, int value)
+{
+	if (desc != &sim_reset_gpio || sim_panel.reset == !!value)
+		return;
+
+	sim_panel.reset = value;
+	if (value)
+		sim_panel_reset();
+}
+
+int gpiod_to_irq(const struct gpio_desc *desc)
+{
+	return -ENXIO;
+}
+
+int devm_request_irq(struct device *dev, unsigned int irq, irqreturn_t (*handler)(int, void *), unsigned long flags,
+		     const char *name, void *dev_id)
+{
+	return -ENXIO;
+}
+
+int devm_regulator_bulk_get(struct device *dev, int num_consumers, struct regulator_bulk_data *consumers)
+{
+	return 0;
+}
+
+int regulator_bulk_enable(int num_consumers, struct regulator_bulk_data *consumers)
+{
+	sim_panel.supplies++;
+
+	return 0;
+}
+
+int regulator_bulk_disable(int num_consumers, struct regulator_bulk_data *consumers)
+{
+	if (!sim_panel.supplies) {
+		fprintf(stderr, "sim: warning: unbalanced regulator_bulk_disable()\n");
+		return -EIO;
+	}
+
+	if (!--sim_panel.supplies)
+		sim_panel_reset();
+
+	return 0;
+}
+
+/**
+ * == Firmware ==
+ *
+ * Requests complete right away, from "sim_firmware_dir" if given.
+ */
+
+int request_firmware_nowait(struct module *module, bool uevent, const char *name, struct device *dev, gfp_t gfp,
+			    void *context, void (*cont)(const struct firmware *fw, void *context))
+{
+	struct firmware *fw = NULL;
+	char path[4096];
+	FILE *file;
+	long size;
+	u8 *data;
+
+	snprintf(path, sizeof(path), "%s/%s", sim_firmware_dir ? sim_firmware_dir : ".", name);
+	file = sim_firmware_dir ? fopen(path, "rb") : NULL;
+	if (file && !fseek(file, 0, SEEK_END) && (size = ftell(file)) >= 0 && !fseek(file, 0, SEEK_SET)) {
+		fw = kzalloc(sizeof(*fw), GFP_KERNEL);
+		data = kmalloc(size ? size : 1, GFP_KERNEL);
+		if (fw && data && fread(data, 1, size, file) == (size_t)size) {
+			fw->data = data;
+			fw->size = size;
+		} else {
+			kfree(data);
+			kfree(fw);
+			fw = NULL;
+		}
+	}
+	if (file)
+		fclose(file);
+
+	cont(fw, context);
+
+	return 0;
+}
+
+void release_firmware(const struct firmware *fw)
+{
+	if (!fw)
+		return;
+
+	kfree(fw->data);
+	kfree(fw);
+}
+
+/**
+ * == debugfs ==
+ */
+
+int seq_printf(struct seq_file *m, const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	vfprintf(m->stream, fmt, args);
+	va_end(args);
+
+	return 0;
+}
+
+int seq_puts(struct seq_file *m, const char *s)
+{
+	fputs(s, m->stream);
+
+	return 0;
+}
+
+int simple_open(struct inode *inode, struct file *file)
+{
+	file->private_data = inode->i_private;
+
+	return 0;
+}
+
+loff_t noop_llseek(struct file *file, loff_t offset, int whence)
+{
+	return offset;
+}
+
+struct dentry *debugfs_create_dir(const char *name, struct dentry *parent)
+{
+	return ERR_PTR(-ENODEV);
+}
+
+struct dentry *debugfs_create_file(const char *name, umode_t mode, struct dentry *parent, void *data,
+				   const struct file_operations *fops)
+{
+	return ERR_PTR(-ENODEV);
+}
+
+void debugfs_remove_recursive(struct dentry *dentry)
+{
+}
+
+/**
+ * == Backlight ==
+ */
+
+static void sim_backlight_release(void *data)
+{
+	kfree(data);
+}
+
+struct backlight_device *devm_backlight_device_register(struct device *dev, const char *name, struct device *parent,
+							 void *devdata, const struct backlight_ops *ops,
+							 const struct backlight_properties *props)
+{
+	struct backlight_device *bl_dev = kzalloc(sizeof(*bl_dev), GFP_KERNEL);
+
+	if (!bl_dev)
+		return ERR_PTR(-ENOMEM);
+
+	bl_dev->props = *props;
+	bl_dev->ops = ops;
+	bl_dev->data = devdata;
+
+	if (devm_add_action_or_reset(dev, sim_backlight_release, bl_dev) < 0)
+		return ERR_PTR(-ENOMEM);
+
+	return bl_dev;
+}
+
+void *bl_get_data(struct backlight_device *bl_dev)
+{
+	return bl_dev->data;
+}
+
+int backlight_enable(struct backlight_device *bl_dev)
+{
+	bl_dev->props.power = FB_BLANK_UNBLANK;
+
+	return bl_dev->ops->update_status(bl_dev);
+}
+
+int backlight_disable(struct backlight_device *bl_dev)
+{
+	bl_dev->props.power = FB_BLANK_POWERDOWN;
+
+	return bl_dev->ops->update_status(bl_dev);
+}
+
+int backlight_device_set_brightness(struct backlight_device *bl_dev, unsigned long brightness)
+{
+	if (brightness > (unsigned long)bl_dev->props.max_brightness)
+		return -EINVAL;
+
+	bl_dev->props.brightness = brightness;
+
+	return bl_dev->ops->update_status(bl_dev);
+}
+
+/**
+ * == DRM ==
+ */
+
+bool drm_rect_intersect(struct drm_rect *r1, const struct drm_rect *r2)
+{
+	r1->x1 = max(r1->x1, r2->x1);
+	r1->y1 = max(r1->y1, r2->y1);
+	r1->x2 = min(r1->x2, r2->x2);
+	r1->y2 = min(r1->y2, r2->y2);
+
+	return r1->x2 > r1->x1 && r1->y2 > r1->y1;
+}
+
+void drm_panel_init(struct drm_panel *panel)
+{
+}
+
+int drm_panel_add(struct drm_panel *panel)
+{
+	return 0;
+}
+
+void drm_panel_remove(struct drm_panel *panel)
+{
+}
+
+struct drm_display_mode *drm_mode_duplicate(struct drm_device *dev, const struct drm_display_mode *mode)
+{
+	struct drm_display_mode *copy = kmalloc(sizeof(*copy), GFP_KERNEL);
+
+	if (copy)
+		*copy = *mode;
+
+	return copy;
+}
+
+void drm_mode_set_name(struct drm_display_mode *mode)
+{
+	snprintf(mode->name, DRM_DISPLAY_MODE_LEN, "%dx%d", mode->hdisplay, mode->vdisplay);
+}
+
+void drm_mode_probed_add(struct drm_connector *connector, struct drm_display_mode *mode)
+{
+	kfree(mode);
+}
+
+int drm_mode_vrefresh(const struct drm_display_mode *mode)
+{
+	if (!mode->htotal || !mode->vtotal)
+		return 0;
+
+	return DIV_ROUND_CLOSEST(mode->clock * 1000, mode->htotal * mode->vtotal);
+}
+
+int drm_display_info_set_bus_formats(struct drm_display_info *info, const u32 *formats, unsigned int num_formats)
+{
+	info->bus_formats = formats;
+	info->num_bus_formats = num_formats;
+
+	return 0;
+}
+
+int drm_connector_init_panel_orientation_property(struct drm_connector *connector, int width, int height)
+{
+	return 0;
+}
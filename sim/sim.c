@@ -0,0 +1,294 @@
+// SPDX-License-Identifier: GPL-2.0-only
+
+/**
+ * Userspace simulation harness of the AM-4001280ATZQW-00H driver
+ *
+ * Builds the driver against the stub headers in "include" and the fake kernel
+ * in "kernel.c", then drives probe, prepare, enable, disable, unprepare and
+ * remove on the host. Reports the DSI bytes sent, the packet count and sleep
+ * budget of each cycle and the CPU time spent per panel callback.
+ *
+ * Usage: am4001280-sim [-n cycles] [-t ms] [-p name[=value,...]]... [-f dir] [-q] [-v]
+ *
+ * Author:
+ * Jan Greiner <jan.greiner@mnet-mail.de>
+ */
+
+#include <getopt.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "panel-ampire-am4001280atzqw00h.c"
+
+/** Log2 buckets of the CPU time histogram, in ns */
+#define SIM_HIST_BUCKETS 32
+
+enum sim_op {
+	SIM_PREPARE,
+	SIM_ENABLE,
+	SIM_DISABLE,
+	SIM_UNPREPARE,
+	SIM_WORK,
+	SIM_OP_COUNT
+};
+
+static const char * const sim_op_names[SIM_OP_COUNT] = {
+	[SIM_PREPARE] = "prepare",
+	[SIM_ENABLE] = "enable",
+	[SIM_DISABLE] = "disable",
+	[SIM_UNPREPARE] = "unprepare",
+	[SIM_WORK] = "work",
+};
+
+struct sim_cpu_stats {
+	u64 count;
+	u64 min_ns;
+	u64 max_ns;
+	u64 total_ns;
+	u64 hist[SIM_HIST_BUCKETS];
+};
+
+static struct sim_cpu_stats sim_cpu_stats[SIM_OP_COUNT];
+
+static u64 sim_cpu_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+
+	return (u64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void sim_cpu_record(enum sim_op op, u64 start)
+{
+	struct sim_cpu_stats *stats = &sim_cpu_stats[op];
+	u64 ns = sim_cpu_ns() - start;
+
+	if (!stats->count || ns < stats->min_ns)
+		stats->min_ns = ns;
+	if (ns > stats->max_ns)
+		stats->max_ns = ns;
+	stats->count++;
+	stats->total_ns += ns;
+	stats->hist[min_t(int, fls64(ns), SIM_HIST_BUCKETS - 1)]++;
+}
+
+/**
+ * Run one panel callback, then let "gap_ms" pass, running the work as it falls due.
+ */
+static int sim_call(enum sim_op op, int (*func)(struct drm_panel *panel), struct drm_panel *panel,
+		    unsigned int gap_ms)
+{
+	u64 start = sim_cpu_ns();
+	int ret;
+
+	ret = func(panel);
+	sim_cpu_record(op, start);
+	if (ret < 0)
+		fprintf(stderr, "sim: %s failed (%d)\n", sim_op_names[op], ret);
+
+	start = sim_cpu_ns();
+	if (sim_idle_us(gap_ms * USEC_PER_MSEC))
+		sim_cpu_record(SIM_WORK, start);
+
+	return ret;
+}
+
+/**
+ * Add a DT property given as "name", "name=string" or "name=value,value,...".
+ */
+static int sim_add_property(struct device_node *np, char *arg)
+{
+	struct sim_property *prop;
+	char *value = strchr(arg, '=');
+	char *end;
+	int i;
+
+	if (value)
+		*value++ = '\0';
+
+	for (i = 0; i < np->num_props && strcmp(np->props[i].name, arg); i++)
+		;
+	if (i == SIM_MAX_PROPERTIES)
+		return -ENOSPC;
+	if (i == np->num_props)
+		np->num_props++;
+
+	prop = &np->props[i];
+	memset(prop, 0, sizeof(*prop));
+	prop->name = arg;
+
+	while (value && *value) {
+		if (prop->count == SIM_PROP_MAX_VALUES)
+			return -EOVERFLOW;
+
+		prop->values[prop->count] = strtoul(value, &end, 0);
+		if (end == value || (*end && *end != ',')) {
+			/** Not a list of numbers, keep it as a string */
+			prop->string = value;
+			prop->count = 0;
+			break;
+		}
+
+		prop->count++;
+		value = *end ? end + 1 : end;
+	}
+
+	return 0;
+}
+
+static void sim_print_cpu_stats(void)
+{
+	const struct sim_cpu_stats *stats;
+	int op, i;
+
+	printf("\nCPU time per callback:\n");
+
+	for (op = 0; op < SIM_OP_COUNT; op++) {
+		stats = &sim_cpu_stats[op];
+		if (!stats->count)
+			continue;
+
+		printf("%s: count=%llu min=%lluns max=%lluns mean=%lluns\n", sim_op_names[op], stats->count,
+		       stats->min_ns, stats->max_ns, stats->total_ns / stats->count);
+
+		for (i = 0; i < SIM_HIST_BUCKETS; i++) {
+			if (!stats->hist[i])
+				continue;
+
+			if (!i)
+				printf("  [0ns, 1ns): %llu\n", stats->hist[i]);
+			else if (i == SIM_HIST_BUCKETS - 1)
+				printf("  [%lluns, inf): %llu\n", 1ull << (i - 1), stats->hist[i]);
+			else
+				printf("  [%lluns, %lluns): %llu\n", 1ull << (i - 1), 1ull << i, stats->hist[i]);
+		}
+	}
+}
+
+static void sim_usage(const char *name)
+{
+	fprintf(stderr,
+		"Usage: %s [-n cycles] [-t ms] [-p name[=value,...]]... [-f dir] [-q] [-v]\n"
+		"  -n  prepare/enable/disable/unprepare cycles to run, 1000 by default\n"
+		"  -t  ms passing after each callback, 20 by default\n"
+		"  -p  add a DT property, \"dsi-lanes=4\" is always set\n"
+		"  -f  directory to load the firmware-name file from\n"
+		"  -q  don't dump the DSI bytes of the first cycle\n"
+		"  -v  print the driver's debug messages\n",
+		name);
+}
+
+int main(int argc, char **argv)
+{
+	static struct device_node np;
+	static struct mipi_dsi_device dsi;
+	struct panel_driver_data *drv_data;
+	struct drm_panel *panel;
+	struct seq_file m = { .stream = stdout };
+	unsigned int cycles = 1000;
+	unsigned int gap_ms = 20;
+	bool quiet = false;
+	unsigned int packets_min = UINT_MAX, packets_max = 0;
+	u64 slept_min = ULLONG_MAX, slept_max = 0;
+	u64 packets_total = 0, bytes_total = 0, slept_total = 0;
+	unsigned int i;
+	int opt;
+	int ret;
+
+	sim_add_property(&np, strdup("dsi-lanes=4"));
+
+	while ((opt = getopt(argc, argv, "n:t:p:f:qvh")) != -1) {
+		switch (opt) {
+		case 'n':
+			cycles = strtoul(optarg, NULL, 0);
+			break;
+		case 't':
+			gap_ms = strtoul(optarg, NULL, 0);
+			break;
+		case 'p':
+			if (sim_add_property(&np, optarg) < 0) {
+				fprintf(stderr, "sim: too many or too long properties\n");
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'f':
+			sim_firmware_dir = optarg;
+			break;
+		case 'q':
+			quiet = true;
+			break;
+		case 'v':
+			sim_log_level = SIM_LOG_DEBUG;
+			break;
+		default:
+			sim_usage(argv[0]);
+			return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+
+	dsi.dev.init_name = "dsi-panel";
+	dsi.dev.of_node = &np;
+	dsi.dev.pm = am4001280atzqw00h_driver.driver.pm;
+
+	ret = am4001280atzqw00h_driver.probe(&dsi);
+	if (ret < 0) {
+		fprintf(stderr, "sim: probe failed (%d)\n", ret);
+		return EXIT_FAILURE;
+	}
+	sim_run_work();
+
+	drv_data = mipi_dsi_get_drvdata(&dsi);
+	panel = &drv_data->panel;
+
+	printf("MCS: %u packets, %zu bytes\n", drv_data->mcs.packets, drv_data->mcs.len);
+
+	for (i = 0; i < cycles; i++) {
+		sim_dsi_log = !i && !quiet ? stdout : NULL;
+		memset(&sim_counters, 0, sizeof(sim_counters));
+
+		if (sim_dsi_log)
+			printf("\nDSI packets of the first cycle:\n");
+
+		sim_call(SIM_PREPARE, panel->funcs->prepare, panel, gap_ms);
+		sim_call(SIM_ENABLE, panel->funcs->enable, panel, gap_ms);
+		sim_call(SIM_DISABLE, panel->funcs->disable, panel, gap_ms);
+		sim_call(SIM_UNPREPARE, panel->funcs->unprepare, panel, gap_ms);
+
+		packets_min = min(packets_min, sim_counters.packets);
+		packets_max = max(packets_max, sim_counters.packets);
+		slept_min = min(slept_min, sim_counters.slept_us);
+		slept_max = max(slept_max, sim_counters.slept_us);
+		packets_total += sim_counters.packets;
+		bytes_total += sim_counters.bytes;
+		slept_total += sim_counters.slept_us;
+	}
+	sim_dsi_log = NULL;
+
+	if (cycles) {
+		printf("\n%u cycles\n", cycles);
+		printf("packets per cycle: min=%u max=%u mean=%llu\n", packets_min, packets_max,
+		       packets_total / cycles);
+		printf("bytes per cycle: mean=%llu\n", bytes_total / cycles);
+		printf("sleep budget per cycle: min=%lluus max=%lluus mean=%lluus\n", slept_min, slept_max,
+		       slept_total / cycles);
+
+		sim_print_cpu_stats();
+
+		printf("\nDriver latency statistics, sleeps included:\n");
+		m.private = drv_data;
+		latency_stats_fops.show(&m, NULL);
+	}
+
+	am4001280atzqw00h_driver.remove(&dsi);
+	sim_run_work();
+	sim_devres_release_all(&dsi.dev);
+
+	if (sim_allocations) {
+		fprintf(stderr, "sim: %ld allocations leaked\n", sim_allocations);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}